@@ -63,6 +63,21 @@ class Universe;
 extern std::map<uint32_t, size_t> surface_id_to_indx;
 extern std::map<uint32_t, size_t> cell_id_to_indx;
 
+//============================================================================
+// CellDistances
+struct CellDistances {
+  // Nearest surface of the cell, of any boundary type
+  double distance = INF;
+  int32_t token = 0;
+
+  // Nearest vacuum or reflective surface of the cell
+  double bc_distance = INF;
+  int32_t bc_token = 0;
+
+  // Shortest distance to any surface of the cell, in any direction
+  double safety = INF;
+};
+
 //============================================================================
 // Cell Class
 class Cell {
@@ -89,6 +104,19 @@ class Cell {
   std::pair<double, int32_t> distance_to_boundary_condition(
       const Position& r, const Direction& u, int32_t on_surf) const;
 
+  // Performs the work of both distance_to_boundary and
+  // distance_to_boundary_condition with a single pass over the surfaces,
+  // and also provides the safety distance of the cell.
+  CellDistances distances(const Position& r, const Direction& u,
+                          int32_t on_surf) const;
+
+  // Returns a copy of this cell, with the same id, name, and fill, but whose
+  // region is the intersection of the regions of this cell and outer.
+  std::shared_ptr<Cell> restricted_to(const Cell& outer) const;
+
+  // True if the cell has no surfaces, and therefore fills all of space
+  bool is_infinite() const { return rpn.empty(); }
+
   Material* material() { return material_raw_; }
 
   Universe* universe() { return universe_raw_; }
@@ -113,6 +141,10 @@ class Cell {
   void check_for_bc();
   void simplify();
 
+  // Region of the cell as a single rpn expression, with the intersection
+  // operators which simplify removes from simple cells.
+  std::vector<int32_t> rpn_expression() const;
+
   std::shared_ptr<Material> material_;
   Material* material_raw_;
 
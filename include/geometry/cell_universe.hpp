@@ -29,7 +29,9 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <atomic>
 #include <map>
+#include <memory>
 
 //===========================================================================
 // Externals from geometry
@@ -52,9 +54,13 @@ class CellUniverse : public Universe {
 
   UniqueCell get_cell(Position r, Direction u, int32_t on_surf) const override;
 
-  UniqueCell get_cell(std::vector<GeoLilyPad>& stack, Position r, Direction u,
+  UniqueCell get_cell(GeoStack& stack, Position r, Direction u,
                       int32_t on_surf) const override;
 
+  UniqueCell get_neighbor_cell(GeoStack& stack, Position r, Direction u,
+                               int32_t on_surf,
+                               uint32_t previous) const override;
+
   Boundary get_boundary_condition(const Position& r, const Direction& u,
                                   int32_t on_surf) const override final;
 
@@ -71,8 +77,35 @@ class CellUniverse : public Universe {
 
   void make_offset_map() override final;
 
+  void flatten() override final;
+
+  uint32_t depth() const override final;
+
+  // If the universe is made of a single cell without any surfaces, which is
+  // filled with another universe, that universe is returned. Otherwise,
+  // returns a nullptr.
+  Universe* trivial_fill() const;
+
+  // Maximum number of neighbors remembered for each cell
+  static constexpr std::size_t NEIGHBOR_SLOTS = 8;
+
  private:
   std::vector<uint32_t> cell_indicies;
+
+  // Neighbor lists, learned while particles are transported. Each cell has
+  // NEIGHBOR_SLOTS entries, which pack the signed surface token which was
+  // crossed into the upper 32 bits, and the position of the neighboring cell
+  // in cell_indicies plus one into the lower 32 bits. Empty slots are zero.
+  // Entries are only ever added with a compare-and-swap, so that the lists
+  // may be shared by all threads without locking.
+  std::unique_ptr<std::atomic<uint64_t>[]> neighbors;
+
+  bool flattened = false;
+
+  UniqueCell enter_cell(GeoStack& stack, std::size_t i, Position r,
+                        Direction u, int32_t on_surf) const;
+
+  void add_neighbor(uint32_t previous, int32_t on_surf, std::size_t i) const;
 };  // CellUniverse
 
 //===========================================================================
@@ -25,9 +25,11 @@
 #ifndef GEO_LILY_PAD_H
 #define GEO_LILY_PAD_H
 
+#include <utils/constants.hpp>
 #include <utils/position.hpp>
 
 #include <array>
+#include <cstddef>
 #include <cstdint>
 
 struct GeoLilyPad {
@@ -35,17 +37,51 @@ struct GeoLilyPad {
 
   GeoLilyPad() {}
   GeoLilyPad(PadType t, uint32_t i, Position r, std::array<int32_t, 3> ti,
-             bool ou)
-      : type(t), id(i), r_local(r), tile(ti), in_lattice_outside_universe(ou) {}
+             bool ou, Position tc = Position())
+      : type(t),
+        id(i),
+        r_local(r),
+        tile(ti),
+        tile_center(tc),
+        in_lattice_outside_universe(ou) {}
 
   PadType type = PadType::Universe;
   uint32_t id = 0;
 
   // r_local is the position within the lattice,
-  // NOT the position within the tile !!
+  // NOT the position within the tile !! It is the position at which the
+  // level was entered, and is not updated as the particle moves.
   Position r_local = Position();
+  // Translation from the global frame to the frame of this level, such that
+  // the current local position is r + offset. This is set by the GeoStack
+  // when the pad is pushed.
+  Position offset = Position();
   std::array<int32_t, 3> tile = {0, 0, 0};
+  // For lattices, the center of the tile in the frame of the lattice, so
+  // that the position in the frame of the tile is r + offset - tile_center.
+  Position tile_center = Position();
+  // For cells, the index of the cell in geometry::cells, and the position
+  // of the cell in the list of its universe. Cells are looked up by index,
+  // as a flattened geometry may contain several cells with the same id.
+  std::size_t cell_index = 0;
+  uint32_t cell_position = 0;
   bool in_lattice_outside_universe = false;
+
+  // Distances to the boundaries of this level, cached by the Tracker. They
+  // are measured along the direction of flight from the point where the
+  // particle had travelled a total path length of dist_path, and are only
+  // valid while dist_epoch matches the direction epoch of the Tracker.
+  double dist = INF;
+  int32_t token = 0;
+  double bc_dist = INF;
+  int32_t bc_token = 0;
+  double dist_path = 0.;
+  uint64_t dist_epoch = 0;
+
+  // Lower bound on the distance to any boundary of this level, in any
+  // direction, from the point where the particle had travelled safety_path.
+  double safety = 0.;
+  double safety_path = 0.;
 };
 
 #endif
@@ -0,0 +1,135 @@
+/*
+ * Abeille Monte Carlo Code
+ * Copyright 2019-2023, Hunter Belanger
+ * Copyright 2021-2022, Commissariat à l'Energie Atomique et aux Energies
+ * Alternatives
+ *
+ * hunter.belanger@gmail.com
+ *
+ * This file is part of the Abeille Monte Carlo code (Abeille).
+ *
+ * Abeille is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Abeille is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Abeille. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * */
+#ifndef GEO_STACK_H
+#define GEO_STACK_H
+
+#include <geometry/geo_lily_pad.hpp>
+#include <utils/position.hpp>
+
+#include <array>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Stack of GeoLilyPads describing the path from the root universe down to
+// the current cell. The first INLINE_CAPACITY levels are stored inside the
+// object, so that constructing a Tracker requires no allocation. Should a
+// geometry be deeper than that, all levels are moved to the heap.
+class GeoStack {
+ public:
+  static constexpr std::size_t INLINE_CAPACITY = 10;
+
+  using iterator = GeoLilyPad*;
+  using const_iterator = const GeoLilyPad*;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  GeoStack() = default;
+  GeoStack(const GeoStack& other) { *this = other; }
+  GeoStack& operator=(const GeoStack& other) {
+    if (this != &other) {
+      clear();
+      set_origin(other.origin_);
+      for (const auto& pad : other) push_pad(pad);
+    }
+    return *this;
+  }
+  ~GeoStack() = default;
+
+  // Global position of the particle while the stack is being filled. Every
+  // pushed pad gets its offset from this position.
+  void set_origin(const Position& r) { origin_ = r; }
+
+  void push_back(const GeoLilyPad& pad) {
+    push_pad(pad);
+    back().offset = pad.r_local - origin_;
+  }
+
+  void pop_back() { size_--; }
+
+  // Only shrinks the stack, as new levels must always be pushed
+  void resize(std::size_t n) {
+    if (n < size_) size_ = n;
+  }
+
+  void clear() {
+    size_ = 0;
+    heap_.clear();
+  }
+
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  GeoLilyPad& operator[](std::size_t i) { return data()[i]; }
+  const GeoLilyPad& operator[](std::size_t i) const { return data()[i]; }
+
+  GeoLilyPad& front() { return data()[0]; }
+  const GeoLilyPad& front() const { return data()[0]; }
+  GeoLilyPad& back() { return data()[size_ - 1]; }
+  const GeoLilyPad& back() const { return data()[size_ - 1]; }
+
+  iterator begin() { return data(); }
+  iterator end() { return data() + size_; }
+  const_iterator begin() const { return data(); }
+  const_iterator end() const { return data() + size_; }
+  reverse_iterator rbegin() { return reverse_iterator(end()); }
+  reverse_iterator rend() { return reverse_iterator(begin()); }
+  const_reverse_iterator rbegin() const {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const {
+    return const_reverse_iterator(begin());
+  }
+
+ private:
+  std::array<GeoLilyPad, INLINE_CAPACITY> inline_;
+  // Only used once the stack has outgrown inline_, in which case it holds
+  // all of the levels.
+  std::vector<GeoLilyPad> heap_;
+  std::size_t size_ = 0;
+  Position origin_ = Position();
+
+  GeoLilyPad* data() { return heap_.empty() ? inline_.data() : heap_.data(); }
+  const GeoLilyPad* data() const {
+    return heap_.empty() ? inline_.data() : heap_.data();
+  }
+
+  void push_pad(const GeoLilyPad& pad) {
+    if (heap_.empty() && size_ < INLINE_CAPACITY) {
+      inline_[size_++] = pad;
+      return;
+    }
+
+    if (heap_.empty()) {
+      heap_.reserve(2 * INLINE_CAPACITY);
+      heap_.assign(inline_.begin(), inline_.end());
+    }
+    heap_.resize(size_);
+    heap_.push_back(pad);
+    size_++;
+  }
+};
+
+#endif
@@ -27,7 +27,7 @@
 
 #include <geometry/boundary.hpp>
 #include <geometry/cell.hpp>
-#include <geometry/geo_lily_pad.hpp>
+#include <geometry/geo_stack.hpp>
 #include <geometry/lattice.hpp>
 #include <geometry/surfaces/surface.hpp>
 #include <geometry/universe.hpp>
@@ -56,8 +56,8 @@ extern std::vector<std::shared_ptr<Universe>> universes;
 // Functions
 UniqueCell get_cell(const Position& r, const Direction& u, int32_t on_surf = 0);
 
-UniqueCell get_cell(std::vector<GeoLilyPad>& stack, const Position& r,
-                    const Direction& u, int32_t on_surf = 0);
+UniqueCell get_cell(GeoStack& stack, const Position& r, const Direction& u,
+                    int32_t on_surf = 0);
 
 int32_t id_to_token(int32_t id);
 
@@ -46,12 +46,16 @@ class HexLattice : public Lattice {
 
   UniqueCell get_cell(Position r, Direction u, int32_t on_surf) const override;
 
-  UniqueCell get_cell(std::vector<GeoLilyPad>& stack, Position r, Direction u,
+  UniqueCell get_cell(GeoStack& stack, Position r, Direction u,
                       int32_t on_surf) const override;
 
   double distance_to_tile_boundary(Position r_local, Direction u,
                                    std::array<int32_t, 3> tile) const override;
 
+  double distance_in_tile(Position r_tile, Direction u) const override;
+
+  double safety_in_tile(Position r_tile) const override;
+
   void set_elements(std::vector<int32_t> univs) override;
 
  private:
@@ -65,6 +69,14 @@ class HexLattice : public Lattice {
   uint32_t width, mid_qr;
   Top top_;
 
+  // The hexagonal tile is the intersection of three slabs, each of width
+  // pitch_, and perpendicular to the direction of one of the neighboring
+  // tiles. face_nx and face_ny are the unit normals of these slabs, and
+  // face_step is the change in (q,r) to get to the neighbor in that
+  // direction.
+  std::array<double, 3> face_nx, face_ny;
+  std::array<std::array<int32_t, 2>, 3> face_step;
+
   std::array<int32_t, 2> get_nearest_hex(Position p) const;
 
   Position get_hex_center(std::array<int32_t, 2> qr) const;
@@ -73,12 +85,10 @@ class HexLattice : public Lattice {
 
   uint32_t get_ring(std::array<int32_t, 2> qr) const;
 
-  double distance_to_tile_boundary_pointy(Position r_tile, Direction u) const;
-
-  double distance_to_tile_boundary_flat(Position r_tile, Direction u) const;
-
-  double distance_to_line(Position r, Direction u, double x1, double y1,
-                          double x2, double y2) const;
+  // Returns the index of the universe filling the tile, and sets indx to the
+  // linear index of the tile. If the tile is outside of the lattice, or is a
+  // dummy element, -1 is returned.
+  int32_t tile_universe(std::array<int32_t, 3> qrz, std::size_t& indx) const;
 
   size_t linear_index(std::array<int32_t, 2> qr, int32_t z) const;
 
@@ -63,8 +63,8 @@ class Lattice : public Universe {
   virtual UniqueCell get_cell(Position r, Direction u,
                               int32_t on_surf) const = 0;
 
-  virtual UniqueCell get_cell(std::vector<GeoLilyPad>& stack, Position r,
-                              Direction u, int32_t on_surf) const = 0;
+  virtual UniqueCell get_cell(GeoStack& stack, Position r, Direction u,
+                              int32_t on_surf) const = 0;
 
   virtual void set_elements(std::vector<int32_t> univs) = 0;
 
@@ -94,6 +94,10 @@ class Lattice : public Universe {
 
   bool contains_universe(uint32_t id) const override;
 
+  void flatten() override final;
+
+  uint32_t depth() const override final;
+
  protected:
   // Any lattice element that is negative gets directed to the
   // outer_universe. If outer_universe_index is also negative,
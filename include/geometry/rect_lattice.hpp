@@ -40,12 +40,16 @@ class RectLattice : public Lattice {
 
   UniqueCell get_cell(Position r, Direction u, int32_t on_surf) const override;
 
-  UniqueCell get_cell(std::vector<GeoLilyPad>& stack, Position r, Direction u,
+  UniqueCell get_cell(GeoStack& stack, Position r, Direction u,
                       int32_t on_surf) const override;
 
   double distance_to_tile_boundary(Position r_local, Direction u,
                                    std::array<int32_t, 3> tile) const override;
 
+  double distance_in_tile(Position r_tile, Direction u) const override;
+
+  double safety_in_tile(Position r_tile) const override;
+
   void set_elements(std::vector<int32_t> univs) override;
 
  private:
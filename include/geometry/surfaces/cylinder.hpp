@@ -38,11 +38,14 @@ class Cylinder : public Surface {
   double distance(const Position& r, const Direction& u,
                   bool on_surf) const override;
 
+  double safety(const Position& r) const override;
+
   Direction norm(const Position& r) const override;
 
  private:
   double x0, y0, z0, u0, v0, w0, R;
   double alpha, beta, gamma;
+  bool axis_aligned;
 
 };  // Cylinder
 
@@ -40,10 +40,13 @@ class Plane : public Surface {
   double distance(const Position& r, const Direction& u,
                   bool on_surf) const override;
 
+  double safety(const Position& r) const override;
+
   Direction norm(const Position& r) const override;
 
  private:
   double A, B, C, D;
+  double inv_norm;
 
 };  // Plane
 
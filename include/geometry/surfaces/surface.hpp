@@ -43,6 +43,11 @@ class Surface {
   virtual double distance(const Position& r, const Direction& u,
                           bool on_surf) const = 0;
 
+  // Returns the shortest distance from r to the surface, considering all
+  // possible directions. This is a lower bound on the value returned by
+  // distance, for any direction u.
+  virtual double safety(const Position& r) const = 0;
+
   virtual Direction norm(const Position& r) const = 0;
 
   BoundaryType boundary() const;
@@ -39,6 +39,8 @@ class XPlane : public Surface {
   double distance(const Position& r, const Direction& u,
                   bool on_surf) const override;
 
+  double safety(const Position& r) const override;
+
   Direction norm(const Position& r) const override;
 
  private:
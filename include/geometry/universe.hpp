@@ -27,7 +27,7 @@
 
 #include <geometry/boundary.hpp>
 #include <geometry/cell.hpp>
-#include <geometry/geo_lily_pad.hpp>
+#include <geometry/geo_stack.hpp>
 
 #include <cstdint>
 
@@ -39,8 +39,16 @@ class Universe {
   virtual UniqueCell get_cell(Position r, Direction u,
                               int32_t on_surf) const = 0;
 
-  virtual UniqueCell get_cell(std::vector<GeoLilyPad>& stack, Position r,
-                              Direction u, int32_t on_surf) const = 0;
+  virtual UniqueCell get_cell(GeoStack& stack, Position r, Direction u,
+                              int32_t on_surf) const = 0;
+
+  // Same as get_cell, but used once the particle has left the cell at
+  // position previous in the universe, by crossing the surface on_surf. This
+  // allows the universe to first look at the cells which are known to be
+  // on the other side of that surface.
+  virtual UniqueCell get_neighbor_cell(GeoStack& stack, Position r,
+                                       Direction u, int32_t on_surf,
+                                       uint32_t previous) const;
 
   virtual Boundary lost_get_boundary(const Position& r, const Direction& u,
                                      int32_t on_surf) const = 0;
@@ -56,6 +64,15 @@ class Universe {
   // TILE!), the distance to the edge of the provided tile is returned.
   virtual double distance_to_tile_boundary(Position r_local, Direction u,
                                            std::array<int32_t, 3> tile) const;
+
+  // Given the position in the frame of the tile, the distance to the edge of
+  // the tile is returned.
+  virtual double distance_in_tile(Position r_tile, Direction u) const;
+
+  // Given the position in the frame of the tile, returns a lower bound on the
+  // distance to the edge of the tile, in any direction. A value of zero
+  // indicates that no bound is available.
+  virtual double safety_in_tile(Position r_tile) const;
   //============================================================================
 
   virtual std::set<uint32_t> get_all_mat_cells() const = 0;
@@ -66,6 +83,14 @@ class Universe {
 
   virtual bool contains_universe(uint32_t id) const = 0;
 
+  // Removes levels from the geometry tree below this universe, without
+  // changing the cell found at any position or its instance number. Must be
+  // called before make_offset_map.
+  virtual void flatten() = 0;
+
+  // Maximum number of levels pushed onto a GeoStack by get_cell
+  virtual uint32_t depth() const = 0;
+
   bool has_boundary_conditions() const { return has_boundary_conditions_; }
 
   uint32_t id() const;
@@ -11,6 +11,7 @@
 
 #include <cstdint>
 #include <optional>
+#include <vector>
 
 class MaterialHelper {
  public:
@@ -23,24 +24,25 @@ class MaterialHelper {
     this->set_energy(E);
   }
 
+  Material* material() const { return mat; }
+
   void set_urr_rand_vals(pcg32& rng) {
-    for (auto& rand : zaid_to_urr_rand_) rand.second = RNG::rand(rng);
+    for (auto& rand : urr_rands_) rand = RNG::rand(rng);
+    has_urr_rands_ = true;
     this->clear_xs();
   }
 
-  void set_urr_rand_vals(
-      const boost::unordered_flat_map<uint32_t, std::optional<double>>& vals) {
-    zaid_to_urr_rand_ = vals;
+  // Sets the URR random numbers, indexed by the URR slot of each nuclide.
+  void set_urr_rand_vals(const std::vector<double>& vals) {
+    urr_rands_ = vals;
+    has_urr_rands_ = true;
     this->clear_xs();
   }
 
-  const boost::unordered_flat_map<uint32_t, std::optional<double>>&
-  urr_rand_vals() const {
-    return zaid_to_urr_rand_;
-  }
+  const std::vector<double>& urr_rand_vals() const { return urr_rands_; }
 
   void clear_urr_rand_vals() {
-    for (auto& rand : zaid_to_urr_rand_) rand.second = std::nullopt;
+    has_urr_rands_ = false;
     this->clear_xs();
   }
 
@@ -280,7 +282,10 @@ class MaterialHelper {
   Material* mat;
   double E_;
   boost::unordered_flat_map<const Nuclide*, std::optional<MicroXSs>> xs_;
-  boost::unordered_flat_map<uint32_t, std::optional<double>> zaid_to_urr_rand_;
+  // URR random numbers, indexed by the URR slot of each nuclide. They are
+  // only used once set by set_urr_rand_vals.
+  std::vector<double> urr_rands_;
+  bool has_urr_rands_;
 
   void clear_xs() {
     // This sets all the MicroXSs objects to nullopt. This typically only
@@ -307,12 +312,10 @@ class MaterialHelper {
     if (it->second.has_value() == false) {
       // We don't have info on this nuclide at this energy yet.
       std::optional<double> urr_rand = std::nullopt;
-      const uint32_t zaid = nuc->zaid();
 
-      // If this zaid has URR info, we should use it
-      if (settings::use_urr_ptables &&
-          zaid_to_urr_rand_.find(zaid) != zaid_to_urr_rand_.end()) {
-        urr_rand = zaid_to_urr_rand_[zaid];
+      // If this nuclide has URR info, we should use it
+      if (settings::use_urr_ptables && has_urr_rands_) {
+        if (const auto slot = nuc->urr_slot()) urr_rand = urr_rands_[*slot];
       }
 
       // Get the micro xs and set it
@@ -45,9 +45,17 @@ class MGAngleDistribution {
   double sample_mu(pcg32& rng) const {
     const double xi = RNG::rand(rng);
 
-    auto cdf_it = std::lower_bound(cdf_.begin(), cdf_.end(), xi);
-    std::size_t l =
-        static_cast<std::size_t>(std::distance(cdf_.begin(), cdf_it));
+    // Flat distributions are inverted directly
+    if (isotropic_) return histogram_interp(xi, 0);
+
+    // The guide table gives the range of CDF points which can contain xi,
+    // so only a few points need to be searched.
+    const std::size_t k = static_cast<std::size_t>(
+        xi * static_cast<double>(guide_.size() - 1));
+    const double* cdf_begin = cdf_.data() + guide_[k];
+    const double* cdf_end = cdf_.data() + guide_[k + 1] + 1;
+    const double* cdf_it = std::lower_bound(cdf_begin, cdf_end, xi);
+    std::size_t l = static_cast<std::size_t>(cdf_it - cdf_.data());
     if (xi == *cdf_it) return mu_[l];
 
     l--;
@@ -74,6 +82,20 @@ class MGAngleDistribution {
     return m * (mu - mu_[l]) + pdf_[l];
   }
 
+  // Evaluates the pdf for the n scattering cosines in mu, and writes the
+  // results to pdf. Isotropic distributions skip the table search.
+  void pdf(const double* mu, double* pdf, std::size_t n) const {
+    if (isotropic_) {
+      std::fill(pdf, pdf + n, pdf_.front());
+      return;
+    }
+
+    for (std::size_t i = 0; i < n; i++) pdf[i] = this->pdf(mu[i]);
+  }
+
+  // True if the pdf has the same value for all scattering cosines.
+  bool isotropic() const { return isotropic_; }
+
   double min_value() const { return mu_.front(); }
 
   double max_value() const { return mu_.back(); }
@@ -88,6 +110,12 @@ class MGAngleDistribution {
   std::vector<double> mu_;
   std::vector<double> pdf_;
   std::vector<double> cdf_;
+  // guide_[k] is the index of the first CDF point which is >= k / G, where
+  // G + 1 is the size of guide_.
+  std::vector<std::size_t> guide_;
+  bool isotropic_;
+
+  void make_guide();
 
   double histogram_interp(double xi, std::size_t l) const {
     return mu_[l] + ((xi - cdf_[l]) / pdf_[l]);
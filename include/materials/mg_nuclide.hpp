@@ -119,10 +119,16 @@ class MGNuclide : public Nuclide {
   std::vector<std::vector<MGAngleDistribution>> angle_dists_;
   std::vector<double> P_delayed_group;
   std::vector<double> delayed_group_decay_constants;
+  // Cumulative distributions used to sample the outgoing scattering group,
+  // the fission group, and the delayed group, built once at construction.
+  std::vector<std::vector<double>> Ps_cdf_;
+  std::vector<std::vector<double>> chi_cdf_;
+  std::vector<double> P_delayed_group_cdf_;
   bool fissile_ = false;
 
   void make_scatter_xs();
   void normalize_chi();
+  void make_sampling_tables();
   void check_sizes() const;
   void check_xs() const;
   void check_fission_data() const;
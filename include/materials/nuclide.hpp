@@ -31,11 +31,14 @@
 #include <cstdint>
 #include <map>
 #include <optional>
-#include <unordered_set>
+#include <unordered_map>
 
 class Nuclide;
 extern std::map<uint32_t, std::shared_ptr<Nuclide>> nuclides;
-extern std::unordered_set<uint32_t> zaids_with_urr;
+// Slot of each ZAID which has a URR, in the URR random number arrays held by
+// MaterialHelper. Nuclides with the same ZAID (at different temperatures)
+// share the same slot, and therefore the same random number.
+extern std::unordered_map<uint32_t, std::size_t> urr_slots;
 
 struct MicroXSs {
   double total = 0.;
@@ -122,9 +125,14 @@ class Nuclide {
 
   uint32_t id() const { return id_; }
 
+  // Slot of the URR random number of the nuclide, if it has a URR.
+  std::optional<std::size_t> urr_slot() const { return urr_slot_; }
+  void set_urr_slot(std::size_t slot) { urr_slot_ = slot; }
+
  private:
   static uint32_t id_counter;
   uint32_t id_;
+  std::optional<std::size_t> urr_slot_ = std::nullopt;
 };
 
 #endif
@@ -84,6 +84,18 @@ class BasicExactMGCancelator : public Cancelator {
     }
   };
 
+  // Sobol positions used to compute <f> and <1/f> in a given bin and
+  // material. They are sampled the first time the bin needs them, and are
+  // then reused in all following generations. Coordinates are stored in
+  // separate arrays so that the averages can be computed with SIMD loops.
+  struct SampleSet {
+    bool built = false;
+    bool valid = false;
+    std::vector<double> x, y, z;
+
+    std::size_t size() const { return x.size(); }
+  };
+
   const Position r_low, r_hi;
   KeyHash hash_fn;
   const double dx, dy, dz;
@@ -91,6 +103,9 @@ class BasicExactMGCancelator : public Cancelator {
   const bool use_sobol;
   std::unordered_map<Key, std::unordered_map<Material*, CancelBin>, KeyHash>
       bins;
+  // Only filled when use_sobol is true. Kept when the cancelator is cleared.
+  std::unordered_map<Key, std::unordered_map<Material*, SampleSet>, KeyHash>
+      sobol_samples;
   const uint32_t N_SAMPLES;
   const uint32_t N_MAX_POS = 100;  // Max number of position samples
 
@@ -99,7 +114,11 @@ class BasicExactMGCancelator : public Cancelator {
 
   void get_averages(const Key& key, Material* mat, CancelBin& bin, pcg32& rng);
 
-  void get_averages_sobol(const Key& key, Material* mat, CancelBin& bin);
+  void get_averages_sobol(const Key& key, Material* mat, CancelBin& bin,
+                          SampleSet& samples);
+
+  void build_sample_set(const Key& key, Material* mat,
+                        SampleSet& samples) const;
 
   Material* get_material(const Position& r) const;
 
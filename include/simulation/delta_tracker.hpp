@@ -41,6 +41,11 @@ class DeltaTracker : public Transporter {
       const NoiseMaker* noise_maker = nullptr);
 
  private:
+  template <typename Mode>
+  std::vector<BankedParticle> transport_particles(
+      std::vector<Particle>& bank, std::vector<BankedParticle>* noise_bank,
+      const NoiseMaker* noise_maker);
+
   std::shared_ptr<pndl::EnergyGrid> EGrid;
   std::shared_ptr<pndl::CrossSection> Emaj;
 };  // DeltaTracker
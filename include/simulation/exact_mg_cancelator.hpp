@@ -109,6 +109,20 @@ class ExactMGCancelator : public Cancelator {
     std::size_t operator()(const Key& key) const { return key.hash_key(); }
   };
 
+  // Quasi-random (position, group) points used to compute <f> and <1/f> in a
+  // given bin and material. They only depend on the bin and the material, so
+  // they are sampled the first time the bin needs to be cancelled, and are
+  // then reused in all following generations. Coordinates are stored in
+  // separate arrays so that the averages can be computed with SIMD loops.
+  struct SampleSet {
+    bool built = false;
+    bool valid = false;
+    std::vector<double> x, y, z;
+    std::vector<std::size_t> g;
+
+    std::size_t size() const { return x.size(); }
+  };
+
   //==========================================================================
   // Data Members
 
@@ -116,6 +130,11 @@ class ExactMGCancelator : public Cancelator {
   std::unordered_map<Key, std::unordered_map<Material*, CancelBin>, KeyHash>
       bins;
 
+  // Sample points of each bin and material. Unlike bins, these are kept when
+  // the cancelator is cleared.
+  std::unordered_map<Key, std::unordered_map<Material*, SampleSet>, KeyHash>
+      sample_sets;
+
   // False if we only have MG materials with a chi vector.
   const bool CHI_MATRIX;
   // Number of samples to use when computing <f> and <1/f>.
@@ -150,9 +169,22 @@ class ExactMGCancelator : public Cancelator {
   std::optional<Position> sample_position(const Key& key, Material* mat,
                                           pcg32& rng) const;
 
+  // Samples the N_SAMPLES points of a bin and material. If a point can't be
+  // sampled, the set is marked as invalid.
+  void build_sample_set(const Key& key, Material* mat,
+                        SampleSet& samples) const;
+
+  // Computes <f> and <1/f> over all sample points, for a particle which
+  // was born from a collision at r1 with direction u1. Returns false if f
+  // is zero for any of the points.
+  bool average_f(const SampleSet& samples, const Position& r1,
+                 const Direction& u1, std::size_t g1, std::size_t g3,
+                 double Esmp, MGNuclide* nuclide,
+                 CancelBin::Averages& averages) const;
+
   // Computes <f> and <1/f> for all particles in all bins.
   void compute_averages(const Key& key, Material* mat, MGNuclide* nuclide,
-                        CancelBin& bin);
+                        CancelBin& bin, SampleSet& samples);
 
   void cancel_bin(CancelBin& bin, MGNuclide* nuclide, bool first_wgt);
 };
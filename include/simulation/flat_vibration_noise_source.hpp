@@ -31,6 +31,7 @@
 #include <complex>
 #include <memory>
 #include <unordered_map>
+#include <vector>
 
 class FlatVibrationNoiseSource : public VibrationNoiseSource {
  public:
@@ -43,17 +44,27 @@ class FlatVibrationNoiseSource : public VibrationNoiseSource {
                            double angular_frequency);
 
   bool is_inside(const Position& r) const override final;
+  const Position& low() const override final { return low_; }
+  const Position& hi() const override final { return hi_; }
+  void set_frequencies(const std::vector<double>& w) override final;
 
-  std::complex<double> dEt(const Position& r, double E,
-                           double w) const override final;
+  std::complex<double> dEt(const Position& r, MaterialHelper& mat, double E,
+                           std::size_t freq) const override final;
 
-  std::complex<double> dEt_Et(const Position& r, double E,
-                              double w) const override final;
+  std::complex<double> dEt_Et(const Position& r, MaterialHelper& mat, double E,
+                              std::size_t freq) const override final;
 
   std::complex<double> dN(const Position& r, uint32_t nuclide_id,
-                          double w) const override final;
+                          std::size_t freq) const override final;
 
  private:
+  // Frequency dependent factors of the source, for one noise frequency w
+  struct Harmonic {
+    bool active;                 // True if w is a multiple of w0_
+    uint32_t n;                  // Absolute value of w / w0_
+    std::complex<double> phase;  // Phase factor if w / w0_ < 0
+  };
+
   Position low_, hi_;
   Basis basis_;
   std::shared_ptr<Material> material_pos_;  // Material on the positive side
@@ -61,12 +72,15 @@ class FlatVibrationNoiseSource : public VibrationNoiseSource {
   double x0_;                               // Midpoint of interface
   double w0_;                               // Angular frequency of vibration
   double eps_;                              // Magnitude of oscillation
+  std::vector<Harmonic> harmonics_;         // Factors of each frequency
   std::unordered_map<uint32_t, double> Delta_N;  // Contians N_neg - N_pos
 
-  // Function to get xs
-  double Et(double x, double E) const;
+  // Function to get the xs of material, using the xs already computed by mat
+  double Et(Material* material, MaterialHelper& mat, double E) const;
   // Function to get Ei_neg(E) - Ei_pos(E)
-  double Delta_Et(double E) const;
+  double Delta_Et(MaterialHelper& mat, double E) const;
+  // Returns C_L or C_R at x, with the phase factor of negative multiples
+  std::complex<double> C(const Harmonic& h, double x) const;
 
   std::complex<double> C_R(uint32_t n, double x) const;
   std::complex<double> C_L(uint32_t n, double x) const;
@@ -28,11 +28,28 @@
 #include <materials/material_helper.hpp>
 #include <materials/nuclide.hpp>
 #include <simulation/particle.hpp>
+#include <utils/mpi.hpp>
 
+#include <highfive/H5File.hpp>
+namespace H5 = HighFive;
 #include <yaml-cpp/yaml.h>
 #include <ndarray.hpp>
 
+#include <cstddef>
 #include <memory>
+#include <utility>
+#include <vector>
+
+// Storage options of a mesh tally. With sparse storage, the scores of each
+// generation are kept as (bin, score) records, and the average and variance
+// are only kept for the bins which have been scored. With single precision,
+// the results are written to the output file as 32 bit floats.
+struct MeshTallyStorage {
+  bool sparse = false;
+  bool single_precision = false;
+};
+
+MeshTallyStorage make_mesh_tally_storage(const YAML::Node& node);
 
 class MeshTally {
  public:
@@ -48,7 +65,8 @@ class MeshTally {
   };
 
   MeshTally(Position low, Position hi, uint64_t nx, uint64_t ny, uint64_t nz,
-            const std::vector<double>& ebounds, std::string fname);
+            const std::vector<double>& ebounds, std::string fname,
+            MeshTallyStorage storage = {});
   virtual ~MeshTally() = default;
 
   virtual std::string estimator_str() const = 0;
@@ -59,13 +77,39 @@ class MeshTally {
 
   void set_net_weight(double W);
 
-  // multiplier must be the same across ALL MPI processes, as it is
-  // applied after the MPI reduction of the generation scores.
+  // Sets the group of the output file in which the batches are streamed
+  void set_stream_group(const std::string& group);
+
+  // The scores of each generation, scaled by multiplier, are summed into
+  // batches of settings::tally_batch_size generations. Once a batch is
+  // complete, its reduction is started, and it is recorded in the average
+  // and variance at the next call, so that the reduction overlaps with the
+  // transport of the next generation. With tally servers, the scores are
+  // instead sent to the servers, which sum them into their batches. Must be
+  // called by all MPI processes.
   void record_generation(double multiplier = 1.);
 
+  // Records the batch being reduced, and the generations of the unfinished
+  // batch as a batch of their own. Must be called by all MPI processes
+  // before the tally is written.
+  void finish_batches();
+
+  // Records the batch being reduced, and sums the unfinished batch on master
+  // so that it can be written to a checkpoint. Must be called by all MPI
+  // processes before write_checkpoint.
+  void gather_batch();
+
   void clear_generation();
 
-  void write_tally();
+  // Must be called by master, and by all tally servers, which send the
+  // statistics of their slices to master.
+  void write_tally(const std::string& group = "results");
+
+  // Saves or restores the running average and variance in a checkpoint.
+  // Only master has a copy of these, so the other nodes only restore the
+  // number of recorded generations.
+  void write_checkpoint(H5::Group& grp) const;
+  void read_checkpoint(const H5::Group& grp);
 
  protected:
   Position r_low, r_hi;
@@ -73,10 +117,85 @@ class MeshTally {
   double dx, dy, dz, dx_inv, dy_inv, dz_inv, net_weight;
   std::vector<double> energy_bounds;
   std::string fname;
+  std::string stream_group = "generations";
+  MeshTallyStorage storage;
 
   NDArray<double> tally_gen;
   NDArray<double> tally_avg;
   NDArray<double> tally_var;
+
+  // Scores of the current batch, which are also reduced in place once the
+  // batch is complete. All MPI processes have a copy.
+  NDArray<double> tally_batch;
+  uint64_t batch_gens = 0;   // Generations in the current batch
+  uint64_t reduce_gens = 0;  // Generations in the batch being reduced
+  mpi::Request reduce_request;
+
+  // With tally servers or sparse storage, the generation scores are not kept
+  // in tally_gen, but as (bin, score) records, one list per thread. With
+  // tally servers, these are sent to the servers owning the bins at the end
+  // of the generation. Each server owns a range of planes, where a plane
+  // holds the (y, z) bins of one energy group and x index, and only holds
+  // the batch, average, and variance of those.
+  struct alignas(64) ThreadRecords {
+    std::vector<std::pair<uint64_t, double>> records;
+    std::size_t compact_size = 0;
+  };
+  std::vector<ThreadRecords> thread_records;
+  std::vector<std::vector<uint64_t>> server_bins;
+  std::vector<std::vector<double>> server_scores;
+  std::vector<mpi::Request> server_requests;
+  uint64_t first_plane = 0;
+  uint64_t nplanes = 0;
+
+  // With sparse storage, the scores of the current batch, and the average
+  // and variance of the bins which have been scored, all sorted by bin. The
+  // bins which have never been scored have an average and variance of zero.
+  // Only master has the statistics, and the batches of all nodes are
+  // gathered on master in batch_bins and batch_scores.
+  std::vector<std::pair<uint64_t, double>> sparse_batch;
+  std::vector<uint64_t> sparse_bins;
+  std::vector<double> sparse_avg;
+  std::vector<double> sparse_var;
+  std::vector<uint64_t> batch_bins;
+  std::vector<double> batch_scores;
+  std::vector<mpi::Request> batch_requests;
+
+  // Adds a score to a bin of the generation scores. May be called by many
+  // threads at once.
+  void add_score(uint64_t e, uint64_t i, uint64_t j, uint64_t k, double scr) {
+    if (!thread_records.empty()) {
+      record_score(((e * Nx + i) * Ny + j) * Nz + k, scr);
+      return;
+    }
+#ifdef ABEILLE_USE_OMP
+#pragma omp atomic
+#endif
+    tally_gen(e, i, j, k) += scr;
+  }
+
+  void record_score(uint64_t bin, double scr);
+  void send_records(double multiplier);
+  void receive_records();
+  int plane_owner(uint64_t plane) const;
+  uint64_t server_first_plane(int server) const;
+
+  // Adds a batch of ngens generations to the average and variance, on the
+  // nodes which hold them.
+  void record_batch(uint64_t ngens);
+  void start_reduction();
+  void finish_reduction();
+
+  // Waits for the sparse batches of all nodes to be gathered, and merges
+  // them into the batch of master
+  void merge_sparse_batches();
+
+  void send_slice() const;
+  void receive_slices(H5::DataSet& avg_dset, H5::DataSet& std_dset) const;
+  void write_sparse_results(H5::DataSet& avg_dset,
+                            H5::DataSet& std_dset) const;
+
+  void write_memory_use() const;
 };
 
 #endif
@@ -30,12 +30,17 @@
 #include <simulation/simulation.hpp>
 
 #include <memory>
+#include <vector>
 
+// The power iteration generations are shared by all noise frequencies. The
+// tallies of the first frequency are also used for the power iteration.
 class Noise : public Simulation {
  public:
-  Noise(std::shared_ptr<Tallies> i_t, std::shared_ptr<Transporter> i_tr,
+  Noise(std::vector<std::shared_ptr<Tallies>> i_t,
+        std::shared_ptr<Transporter> i_tr,
         std::vector<std::shared_ptr<Source>> srcs, NoiseMaker noise_mkr)
-      : Simulation(i_t, i_tr, srcs),
+      : Simulation(i_t.front(), i_tr, srcs),
+        frequency_tallies(i_t),
         noise_maker(noise_mkr),
         bank(),
         noise_bank(),
@@ -45,10 +50,12 @@ class Noise : public Simulation {
         convergence_timer(),
         noise_batch_timer() {}
 
-  Noise(std::shared_ptr<Tallies> i_t, std::shared_ptr<Transporter> i_tr,
+  Noise(std::vector<std::shared_ptr<Tallies>> i_t,
+        std::shared_ptr<Transporter> i_tr,
         std::vector<std::shared_ptr<Source>> srcs,
         std::shared_ptr<Cancelator> cancel, NoiseMaker noise_mkr)
-      : Simulation(i_t, i_tr, srcs),
+      : Simulation(i_t.front(), i_tr, srcs),
+        frequency_tallies(i_t),
         noise_maker(noise_mkr),
         bank(),
         noise_bank(),
@@ -64,6 +71,7 @@ class Noise : public Simulation {
   void premature_kill() override final;
 
  private:
+  std::vector<std::shared_ptr<Tallies>> frequency_tallies;
   NoiseMaker noise_maker;
   std::vector<Particle> bank;
   std::vector<BankedParticle> noise_bank;
@@ -93,8 +101,8 @@ class Noise : public Simulation {
   void power_iteration(bool sample_noise);
   void pi_generation_output();
 
-  void noise_simulation();
-  void noise_output();
+  void noise_simulation(std::size_t freq);
+  void noise_output(std::size_t freq);
 
   void print_header() const;
 
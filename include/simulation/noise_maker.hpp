@@ -32,7 +32,10 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <array>
+#include <map>
 #include <memory>
+#include <shared_mutex>
 #include <vector>
 
 class NoiseMaker {
@@ -42,57 +45,122 @@ class NoiseMaker {
   void add_noise_source(const YAML::Node& snode);
 
   void add_noise_source(std::shared_ptr<VibrationNoiseSource> ns) {
+    if (!w_.empty()) ns->set_frequencies(w_);
     vibration_noise_sources_.push_back(ns);
+    fake_materials_ = std::make_shared<FakeMaterialCache>();
+    source_grid_.reset();
   }
 
   void add_noise_source(std::shared_ptr<OscillationNoiseSource> ns) {
+    if (!w_.empty()) ns->set_frequencies(w_);
     oscillation_noise_sources_.push_back(ns);
+    source_grid_.reset();
   }
 
+  // Sets the angular frequencies of the noise, and computes the frequency
+  // dependent factors of all noise sources for them. Noise particles are
+  // sampled for all frequencies at each collision, and are tagged with the
+  // index of their frequency in w.
+  void set_frequencies(const std::vector<double>& w);
+
+  std::size_t num_frequencies() const { return w_.size(); }
+
+  // Builds the grid used to find the noise sources which contain the site of
+  // a collision. Until it is built, all sources are checked at each
+  // collision. Adding a source discards the grid.
+  void build_source_grid();
+
   std::size_t num_noise_sources() const {
     return vibration_noise_sources_.size() + oscillation_noise_sources_.size();
   }
 
-  void sample_noise_source(Particle& p, MaterialHelper& mat, const double keff,
-                           const double w) const;
+  // Samples the noise particles of a collision. The MaterialHelper must be
+  // that of the material in which the collision occurs.
+  void sample_noise_source(Particle& p, MaterialHelper& mat,
+                           const double keff) const;
 
  private:
+  // Fictitious materials used to sample the vibration noise source, for each
+  // combination of overlapping vibration noise sources. The key is the sorted
+  // list of indices of the sources in vibration_noise_sources_. Materials are
+  // built the first time their combination is encountered, and are then
+  // shared by all threads (and all copies of the NoiseMaker).
+  struct FakeMaterialCache {
+    std::shared_mutex mutex;
+    std::map<std::vector<uint32_t>, std::unique_ptr<Material>> materials;
+  };
+
+  // Indices of the noise sources which contain the site of a collision, in
+  // vibration_noise_sources_ and oscillation_noise_sources_, in increasing
+  // order. They are found once per collision, and then used to sample all of
+  // the noise particles.
+  struct ActiveSources {
+    std::vector<uint32_t> vibration;
+    std::vector<uint32_t> oscillation;
+
+    bool empty() const { return vibration.empty() && oscillation.empty(); }
+  };
+
+  // Uniform Cartesian grid over the box containing all of the noise sources.
+  // Each grid cell has the list of the sources whose box overlaps the cell,
+  // where the oscillation sources are numbered after the vibration sources.
+  // The lists of all cells are stored one after the other in sources, with
+  // the list of cell i going from offsets[i] to offsets[i+1].
+  struct SourceGrid {
+    std::array<double, 3> low;
+    std::array<double, 3> inv_width;  // Inverse of the width of a grid cell
+    std::array<int32_t, 3> shape;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> sources;
+  };
+
   std::vector<std::shared_ptr<VibrationNoiseSource>> vibration_noise_sources_;
   std::vector<std::shared_ptr<OscillationNoiseSource>>
       oscillation_noise_sources_;
+  std::shared_ptr<FakeMaterialCache> fake_materials_ =
+      std::make_shared<FakeMaterialCache>();
+  std::shared_ptr<const SourceGrid> source_grid_;
+  std::vector<double> w_;
 
-  bool is_inside(const Particle& p) const;
-  std::complex<double> dEt(const Particle& p, double w) const;
+  void get_active_sources(const Position& r, ActiveSources& active) const;
+  std::complex<double> dEt(const Particle& p, MaterialHelper& mat,
+                           const ActiveSources& active,
+                           std::size_t freq) const;
   std::complex<double> dN(const Position& r, uint32_t nuclide_id,
-                          double w) const;
-  std::unique_ptr<Material> make_fake_material(const Particle& p) const;
+                          const std::vector<uint32_t>& sources,
+                          std::size_t freq) const;
+  std::complex<double> delayed_multiplier(double lambda,
+                                          std::size_t freq) const;
+  Material* get_fake_material(const std::vector<uint32_t>& sources) const;
+  std::unique_ptr<Material> make_fake_material(
+      const std::vector<uint32_t>& sources) const;
 
   void sample_noise_copy(Particle& p, MaterialHelper& mat,
-                         const double w) const;
+                         const ActiveSources& active) const;
 
   void sample_vibration_noise_source(Particle& p, MaterialHelper& mat,
-                                     const double keff, const double w) const;
-  void sample_vibration_noise_fission(Particle& p, const Nuclide& nuclide,
-                                      const MicroXSs& microxs,
-                                      const std::complex<double>& dN_N,
-                                      const double Etfake_Et, const double keff,
-                                      const double w) const;
-  void sample_vibration_noise_scatter(Particle& p, const Nuclide& nuclide,
-                                      const MicroXSs& microxs,
-                                      const std::complex<double>& dN_N,
-                                      const double Etfake_Et,
-                                      const double P_scatter) const;
+                                     const std::vector<uint32_t>& sources,
+                                     const double keff) const;
+  void sample_vibration_noise_fission(
+      Particle& p, const Nuclide& nuclide, const MicroXSs& microxs,
+      const std::vector<std::complex<double>>& dN_N, const double Etfake_Et,
+      const double keff) const;
+  void sample_vibration_noise_scatter(
+      Particle& p, const Nuclide& nuclide, const MicroXSs& microxs,
+      const std::vector<std::complex<double>>& dN_N, const double Etfake_Et,
+      const double P_scatter) const;
 
   void sample_oscillation_noise_source(Particle& p, MaterialHelper& mat,
-                                       const double keff, const double w) const;
+                                       const std::vector<uint32_t>& sources,
+                                       const double keff) const;
   void sample_oscillation_noise_fission(Particle& p, const Nuclide& nuclide,
                                         const MicroXSs& microxs,
-                                        const double keff,
-                                        const double w) const;
+                                        const std::vector<uint32_t>& sources,
+                                        const double keff) const;
   void sample_oscillation_noise_scatter(Particle& p, const Nuclide& nuclide,
                                         const MicroXSs& microxs,
-                                        const double P_scatter,
-                                        const double w) const;
+                                        const std::vector<uint32_t>& sources,
+                                        const double P_scatter) const;
 };
 
 #endif
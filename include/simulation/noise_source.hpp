@@ -30,6 +30,9 @@
 #include <yaml-cpp/yaml.h>
 
 #include <complex>
+#include <vector>
+
+class MaterialHelper;
 
 // Pure virtual interface to allow for the sampling of neutron noise particles.
 class NoiseSource {
@@ -39,11 +42,23 @@ class NoiseSource {
 
   virtual bool is_inside(const Position& r) const = 0;
 
-  virtual std::complex<double> dEt(const Position& r, double E,
-                                   double w) const = 0;
+  // Lower and upper corners of a box which contains the whole source.
+  virtual const Position& low() const = 0;
+  virtual const Position& hi() const = 0;
+
+  // Computes all the factors of the source which only depend on the noise
+  // angular frequencies w. This must be called once, before the source is
+  // evaluated. All other methods then return the values at the angular
+  // frequency w[freq].
+  virtual void set_frequencies(const std::vector<double>& w) = 0;
+
+  // The MaterialHelper is that of the material at r, where the particle is
+  // currently located, already evaluated at energy E.
+  virtual std::complex<double> dEt(const Position& r, MaterialHelper& mat,
+                                   double E, std::size_t freq) const = 0;
 
-  virtual std::complex<double> dEt_Et(const Position& r, double E,
-                                      double w) const = 0;
+  virtual std::complex<double> dEt_Et(const Position& r, MaterialHelper& mat,
+                                      double E, std::size_t freq) const = 0;
 };
 
 #endif
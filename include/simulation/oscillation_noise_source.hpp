@@ -34,17 +34,14 @@ class OscillationNoiseSource : public NoiseSource {
   OscillationNoiseSource() = default;
   virtual ~OscillationNoiseSource() = default;
 
-  virtual std::complex<double> dEt_Et(const Position& r, double E,
-                                      double w) const = 0;
-
   virtual std::complex<double> dEf_Ef(const Position& r, double E,
-                                      double w) const = 0;
+                                      std::size_t freq) const = 0;
 
   virtual std::complex<double> dEelastic_Eelastic(const Position& r, double E,
-                                                  double w) const = 0;
+                                                  std::size_t freq) const = 0;
 
   virtual std::complex<double> dEmt_Emt(uint32_t mt, const Position& r,
-                                        double E, double w) const = 0;
+                                        double E, std::size_t freq) const = 0;
 };
 
 #endif
@@ -48,7 +48,9 @@ struct BankedParticle {
   uint64_t parent_daughter_id;
   uint64_t family_id;
 
-  // For use in performing cancellation
+  // For use in performing cancellation. These members are only sent with MPI
+  // when cancellation is being performed, so they should never be used for
+  // anything else.
   bool parents_previous_was_virtual = false;
   Position parents_previous_position = Position();     // R1
   Direction parents_previous_direction = Direction();  // U1
@@ -56,6 +58,11 @@ struct BankedParticle {
   double parents_previous_energy = 0;                  // E3
   double Esmp_parent = 0.;
 
+  // Index of the angular frequency of a noise particle. It is only used to
+  // split the noise source by frequency, before the banks are distributed
+  // amongst the processes, and is therefore not sent with MPI.
+  uint32_t noise_frequency = 0;
+
   bool operator<(const BankedParticle& rhs) const {
     if (parent_history_id < rhs.parent_history_id) return true;
     if (parent_history_id == rhs.parent_history_id &&
@@ -58,6 +58,7 @@ class PowerIterator : public Simulation {
   std::vector<int> Nnet_vec{}, Npos_vec{}, Nneg_vec{}, Ntot_vec{};
   std::vector<int> Wnet_vec{}, Wpos_vec{}, Wneg_vec{}, Wtot_vec{};
   int gen = 0;
+  int restart_gen = 0;  // Last generation of the checkpoint restarted from
   double r_sqrd = 0.;
   std::vector<double> r_sqrd_vec;
 
@@ -86,6 +87,11 @@ class PowerIterator : public Simulation {
   void sample_source_from_sources();
   void load_source_from_file();
 
+  // Checkpoints hold the full state of the simulation after a generation, so
+  // that a restarted run continues exactly as the original would have.
+  void write_checkpoint();
+  void read_checkpoint();
+
 };  // PowerIterator
 
 #endif  // MG_POWER_ITERATOR_H
@@ -30,10 +30,14 @@
 #include <simulation/source.hpp>
 #include <simulation/tallies.hpp>
 #include <simulation/transporter.hpp>
+#include <utils/mpi.hpp>
 #include <utils/rng.hpp>
 #include <utils/settings.hpp>
 #include <utils/timer.hpp>
 
+#include <highfive/H5File.hpp>
+namespace H5 = HighFive;
+
 #include <sstream>
 
 class Simulation {
@@ -80,6 +84,7 @@ class Simulation {
   std::vector<std::shared_ptr<Source>> sources;
 
   Timer simulation_timer;
+  Timer transport_timer;
 
   uint64_t histories_counter = 0;
   uint64_t global_histories_counter = 0;
@@ -103,15 +108,47 @@ class Simulation {
   std::vector<double> empty_entropy_frac_vec;
 
   void sync_signaled();
+
+  // When streaming generations, queues the entropies of the last generation
+  // to be written to the output file.
+  void stream_entropy() const;
+
+  // When using the adaptive distribution, updates the share of particles
+  // given to each node from the time this node took to transport nparticles,
+  // as measured by transport_timer.
+  void update_rank_weights(std::size_t nparticles);
   void sync_banks(std::vector<uint64_t>& nums,
                   std::vector<BankedParticle>& bank);
 
-  void particles_to_master(std::vector<BankedParticle>& bank);
+  // Starts sending all particles to the master. The bank may be read, but
+  // not modified, until the returned request has been waited on.
+  mpi::Request particles_to_master(std::vector<BankedParticle>& bank);
   void distribute_particles(std::vector<uint64_t>& nums,
                             std::vector<BankedParticle>& bank);
 
+  // Loads the particles of this node from the source file. Each node only
+  // reads the rows of the source dataset which it is responsible for.
+  void load_source_file(std::vector<Particle>& bank);
+
+  // Writes the particles of all nodes to the source dataset of the output
+  // file, in rank order. Master receives and writes the particles of the
+  // other nodes one chunk at a time, instead of gathering the whole bank.
   void write_source(std::vector<Particle>& bank) const;
 
+  // Writes the state shared by all simulations, along with the particles of
+  // all nodes, to a checkpoint file. The file is only open on master, and
+  // checkpoint is nullptr on the other nodes. The mesh tally batches must
+  // have been gathered with Tallies::gather_mesh_tally_batches before the
+  // file was opened.
+  void write_checkpoint_state(H5::File* checkpoint,
+                              const std::vector<Particle>& bank) const;
+
+  // Restores the state written by write_checkpoint_state. Each node only
+  // reads the particles of the bank which it is responsible for, and gives
+  // them the same history ids they had when the checkpoint was written.
+  void read_checkpoint_state(const H5::File& checkpoint,
+                             std::vector<Particle>& bank);
+
 };  // Simulation
 
 #endif  // MG_SIMULATION_H
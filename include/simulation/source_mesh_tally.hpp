@@ -36,8 +36,8 @@ class SourceMeshTally : public MeshTally {
 
   SourceMeshTally(Position low, Position hi, uint64_t nx, uint64_t ny,
                   uint64_t nz, const std::vector<double>& ebounds, Quantity q,
-                  std::string fname)
-      : MeshTally(low, hi, nx, ny, nz, ebounds, fname), quantity(q) {}
+                  std::string fname, MeshTallyStorage storage = {})
+      : MeshTally(low, hi, nx, ny, nz, ebounds, fname, storage), quantity(q) {}
 
   void score_source(const BankedParticle& p);
 
@@ -30,6 +30,8 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <vector>
+
 class SquareOscillationNoiseSource : public OscillationNoiseSource {
  public:
   SquareOscillationNoiseSource(Position low, Position hi, double eps_tot,
@@ -37,21 +39,27 @@ class SquareOscillationNoiseSource : public OscillationNoiseSource {
                                double angular_frequency);
 
   bool is_inside(const Position& r) const override final;
-  std::complex<double> dEt(const Position& r, double E,
-                           double w) const override final;
+  const Position& low() const override final { return low_; }
+  const Position& hi() const override final { return hi_; }
+  void set_frequencies(const std::vector<double>& w) override final;
+
+  std::complex<double> dEt(const Position& r, MaterialHelper& mat, double E,
+                           std::size_t freq) const override final;
 
-  std::complex<double> dEt_Et(const Position& r, double E,
-                              double w) const override final;
+  std::complex<double> dEt_Et(const Position& r, MaterialHelper& mat, double E,
+                              std::size_t freq) const override final;
   std::complex<double> dEf_Ef(const Position& r, double E,
-                              double w) const override final;
-  std::complex<double> dEelastic_Eelastic(const Position& r, double E,
-                                          double w) const override final;
+                              std::size_t freq) const override final;
+  std::complex<double> dEelastic_Eelastic(
+      const Position& r, double E, std::size_t freq) const override final;
   std::complex<double> dEmt_Emt(uint32_t mt, const Position& r, double E,
-                                double w) const override final;
+                                std::size_t freq) const override final;
 
  private:
   Position low_, hi_;
   double w0_;
+  // For each frequency, PI if w = +/- w0, and 0 otherwise
+  std::vector<double> amplitude_;
   double eps_t_;
   double eps_f_;
   double eps_s_;
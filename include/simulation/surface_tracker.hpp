@@ -38,6 +38,12 @@ class SurfaceTracker : public Transporter {
       std::vector<BankedParticle>* noise_bank = nullptr,
       const NoiseMaker* noise_maker = nullptr);
 
+ private:
+  template <typename Mode>
+  std::vector<BankedParticle> transport_particles(
+      std::vector<Particle>& bank, std::vector<BankedParticle>* noise_bank,
+      const NoiseMaker* noise_maker);
+
 };  // SurfaceTracker
 
 #endif  // MG_SURFACE_TRACKER_H
@@ -31,6 +31,8 @@
 #include <simulation/source_mesh_tally.hpp>
 #include <simulation/track_length_mesh_tally.hpp>
 
+#include <highfive/H5File.hpp>
+namespace H5 = HighFive;
 #include <yaml-cpp/yaml.h>
 
 #include <string>
@@ -144,15 +146,31 @@ class Tallies {
     return std::sqrt(mig_var / static_cast<double>(gen));
   }
 
-  void write_tallies();
+  // Writes all results in the given group of the output file.
+  void write_tallies(const std::string& group = "results");
 
   void set_total_weight(double tot_wgt) { total_weight = tot_wgt; }
 
+  // Sets the group of the output file in which the values of each
+  // generation, and the batches of the mesh tallies, are streamed.
+  void set_stream_group(const std::string& group);
+
   int generations() const { return gen; }
 
+  // Saves or restores the running statistics of all estimators, and of all
+  // mesh tallies, in a group of a checkpoint file. Only master writes the
+  // checkpoint, but all nodes read it back.
+  void write_checkpoint(H5::Group& grp) const;
+  void read_checkpoint(const H5::Group& grp);
+
+  // Prepares the mesh tallies for a checkpoint, by summing their unfinished
+  // batches on master. Must be called by all nodes before write_checkpoint.
+  void gather_mesh_tally_batches();
+
  private:
   int gen = 0;
   double keff_ = 1.;
+  std::string stream_group_ = "generations";
 
   double total_weight;
 
@@ -33,8 +33,11 @@ class TrackLengthMeshTally : public MeshTally {
  public:
   TrackLengthMeshTally(Position low, Position hi, uint64_t nx, uint64_t ny,
                        uint64_t nz, const std::vector<double>& ebounds,
-                       Quantity q, std::string fname, uint32_t mt = 0)
-      : MeshTally(low, hi, nx, ny, nz, ebounds, fname), quantity(q), mt_(mt) {}
+                       Quantity q, std::string fname, uint32_t mt = 0,
+                       MeshTallyStorage storage = {})
+      : MeshTally(low, hi, nx, ny, nz, ebounds, fname, storage),
+        quantity(q),
+        mt_(mt) {}
 
   void score_flight(const Particle& p, double d, MaterialHelper& mat);
 
@@ -27,7 +27,7 @@
 
 #include <geometry/boundary.hpp>
 #include <geometry/cell.hpp>
-#include <geometry/geo_lily_pad.hpp>
+#include <geometry/geo_stack.hpp>
 #include <geometry/geometry.hpp>
 #include <materials/material.hpp>
 #include <simulation/particle.hpp>
@@ -35,6 +35,7 @@
 #include <utils/error.hpp>
 #include <utils/parser.hpp>
 
+#include <algorithm>
 #include <sstream>
 #include <stdexcept>
 
@@ -42,9 +43,7 @@ class Tracker {
  public:
   Tracker(Position i_r, Direction i_u, int32_t token = 0)
       : r_(i_r), u_(i_u), tree(), surface_token_(token) {
-    // Allocate enough space for at least 10 levels
-    tree.reserve(10);
-
+    tree.set_origin(r_);
     current_cell = geometry::get_cell(tree, r_, u_, surface_token_);
     if (current_cell) current_mat = current_cell.cell->material();
   };
@@ -57,11 +56,22 @@ class Tracker {
   void set_r(Position r) {
     r_ = r;
     surface_token_ = 0;
+
+    // The tree no longer describes where we are after a jump, and must be
+    // searched again by get_current.
+    direction_epoch_++;
+    tree.clear();
+  }
+  void set_u(Direction u) {
+    u_ = u;
+
+    // Cached distances were all computed along the old direction
+    direction_epoch_++;
   }
-  void set_u(Direction u) { u_ = u; }
 
   void restart_get_current() {
     tree.clear();
+    tree.set_origin(r_);
     current_cell = geometry::get_cell(tree, r_, u_, surface_token_);
     if (current_cell) {
       if (current_cell.cell->fill() == Cell::Fill::Universe) {
@@ -74,13 +84,10 @@ class Tracker {
   }
 
   void move(double d) {
+    // The levels of the tree only store their offset from r_, so they
+    // follow the particle without being updated.
     r_ = r_ + d * u_;
-
-    // Go update positions inside tree
-    for (auto& leaf : tree) {
-      leaf.r_local = leaf.r_local + d * u_;
-    }
-
+    path_ += std::abs(d);
     surface_token_ = 0;
   }
 
@@ -101,14 +108,14 @@ class Tracker {
       // Go up the entire tree
       for (const auto& pad : tree) {
         if (pad.type == GeoLilyPad::PadType::Cell) {
-          auto cell_id = cell_id_to_indx[pad.id];
-          Cell* cell = geometry::cells[cell_id].get();
+          Cell* cell = geometry::cells[pad.cell_index].get();
 
           // Only consider cells which have a boundary condition.
           if (cell->vacuum_or_reflective() == false) continue;
 
-          auto d_t = cell->distance_to_boundary_condition(pad.r_local, u_,
-                                                          surface_token_);
+          const Position r_local = local_position(pad);
+          auto d_t =
+              cell->distance_to_boundary_condition(r_local, u_, surface_token_);
           if (d_t.first < dist && std::abs(d_t.first - dist) > BOUNDRY_TOL) {
             double tmp_dist = d_t.first;
             int32_t tmp_token = std::abs(d_t.second);
@@ -126,15 +133,15 @@ class Tracker {
                         ->boundary();
 
             if (geometry::surfaces[static_cast<std::size_t>(surface_index)]
-                    ->sign(pad.r_local, u_) < 0)
+                    ->sign(r_local, u_) < 0)
               token *= -1;
           }
         } else if (pad.type != GeoLilyPad::PadType::Cell) {
           auto uni_indx = universe_id_to_indx[pad.id];
           Universe* uni = geometry::universes[uni_indx].get();
           if (uni->has_boundary_conditions()) {
-            Boundary uni_bound =
-                uni->get_boundary_condition(pad.r_local, u_, surface_token_);
+            Boundary uni_bound = uni->get_boundary_condition(
+                local_position(pad), u_, surface_token_);
             if (uni_bound.distance < dist &&
                 std::abs(uni_bound.distance - dist) > BOUNDRY_TOL) {
               dist = uni_bound.distance;
@@ -160,68 +167,66 @@ class Tracker {
     }
   }
 
-  Boundary get_nearest_boundary() const {
-    if (!this->is_lost()) {
-      // This must be first, so that we make sure that boundary condition
-      // surfaces are given the higher priority. That is, we need to really be
-      // closer to another surface, to ignore the boundary condition surface.
-      auto bound = this->get_boundary_condition();
+  Boundary get_nearest_boundary() {
+    if (this->is_lost()) {
+      return geometry::root_universe->lost_get_boundary(r_, u_, surface_token_);
+    }
 
-      double dist = bound.distance;
-      BoundaryType btype = bound.boundary_type;
-      int surface_index = bound.surface_index;
-      int32_t token = bound.token;
+    // Bring the distances of every level up to date, starting from the
+    // deepest level, as it is the most likely to contain the nearest surface.
+    double best = INF;
+    for (auto it = tree.rbegin(); it != tree.rend(); it++) {
+      update_distances(*it, best);
+    }
 
-      // Go up the entire tree
-      for (const auto& pad : tree) {
-        if (pad.type == GeoLilyPad::PadType::Lattice) {
-          const auto lat_indx = universe_id_to_indx[pad.id];
-          const auto& lat = geometry::universes[lat_indx];
-          double d = lat->distance_to_tile_boundary(pad.r_local, u_, pad.tile);
-          if (d < dist && std::abs(d - dist) > BOUNDRY_TOL) {
-            dist = d;
-            btype = BoundaryType::Normal;
-            surface_index = -1;
-            token = 0;
-          }
-        } else if (pad.type == GeoLilyPad::PadType::Cell) {
-          auto cell_id = cell_id_to_indx[pad.id];
-          auto d_t = geometry::cells[cell_id]->distance_to_boundary(
-              pad.r_local, u_, surface_token_);
-          if (d_t.first < dist && std::abs(d_t.first - dist) > BOUNDRY_TOL) {
-            dist = d_t.first;
-            token = std::abs(d_t.second);
+    double dist = INF;
+    BoundaryType btype = BoundaryType::Vacuum;
+    int surface_index = -1;
+    int32_t token = 0;
+
+    // Boundary condition surfaces must be considered first, so that they are
+    // given the higher priority. That is, we need to really be closer to
+    // another surface, to ignore the boundary condition surface.
+    for (const auto& pad : tree) {
+      // Levels which were skipped can not contain the nearest boundary
+      if (pad.dist_epoch != direction_epoch_ || pad.bc_token == 0) continue;
+
+      const double d = pad.bc_dist - (path_ - pad.dist_path);
+      if (d < dist && std::abs(d - dist) > BOUNDRY_TOL) {
+        dist = d;
+        token = pad.bc_token;
+        surface_index = std::abs(token) - 1;
+        btype = geometry::surfaces[static_cast<std::size_t>(surface_index)]
+                    ->boundary();
+      }
+    }
 
-            if (token) {
-              surface_index = token - 1;
-            } else {
-              surface_index = -1;
-            }
+    // Go up the entire tree
+    for (const auto& pad : tree) {
+      if (pad.dist_epoch != direction_epoch_) continue;
 
-            if (surface_index >= 0)
-              btype =
-                  geometry::surfaces[static_cast<std::size_t>(surface_index)]
-                      ->boundary();
-            else
-              btype = BoundaryType::Normal;
+      const double d = pad.dist - (path_ - pad.dist_path);
+      if (d < dist && std::abs(d - dist) > BOUNDRY_TOL) {
+        dist = d;
+        token = pad.token;
 
-            if (surface_index >= 0 &&
-                geometry::surfaces[static_cast<std::size_t>(surface_index)]
-                        ->sign(pad.r_local, u_) < 0)
-              token *= -1;
-          }
+        if (token) {
+          surface_index = std::abs(token) - 1;
+          btype = geometry::surfaces[static_cast<std::size_t>(surface_index)]
+                      ->boundary();
+        } else {
+          surface_index = -1;
+          btype = BoundaryType::Normal;
         }
       }
+    }
 
-      Boundary ret_bound(dist, surface_index, btype);
-      ret_bound.token = token;
+    Boundary ret_bound(dist, surface_index, btype);
+    ret_bound.token = token;
 
-      // Distance to surface, and token, with sign indicating the positions
-      // current orientation to the surface.
-      return ret_bound;
-    } else {
-      return geometry::root_universe->lost_get_boundary(r_, u_, surface_token_);
-    }
+    // Distance to surface, and token, with sign indicating the positions
+    // current orientation to the surface.
+    return ret_bound;
   }
 
   void cross_surface(Boundary d_t) {
@@ -244,7 +249,7 @@ class Tracker {
       if (!check_tree()) {
         std::stringstream mssg;
         mssg << " BAD POSITIONS!\n r_ = " << r_
-             << "\n rl = " << tree.front().r_local << "\n";
+             << "\n rl = " << local_position(tree.front()) << "\n";
         fatal_error(mssg.str());
       }
     }
@@ -252,16 +257,15 @@ class Tracker {
     // Go back through tree, and see where we are no-longer inside
     for (auto it = tree.begin(); it != tree.end(); it++) {
       if (it->type == GeoLilyPad::PadType::Cell) {
-        auto cell_indx = cell_id_to_indx[it->id];
-        const auto& cell = geometry::cells[cell_indx];
-        if (!cell->is_inside(it->r_local, u_, surface_token_)) {
+        const auto& cell = geometry::cells[it->cell_index];
+        if (!cell->is_inside(local_position(*it), u_, surface_token_)) {
           first_bad = it;
           break;
         }
       } else if (it->type == GeoLilyPad::PadType::Lattice) {
         const auto lat_indx = universe_id_to_indx[it->id];
         const auto& lat = geometry::universes[lat_indx];
-        auto tile = lat->get_tile(it->r_local, u_);
+        auto tile = lat->get_tile(local_position(*it), u_);
         // Check if tile has changed
         if (it->tile[0] != tile[0] || it->tile[1] != tile[1] ||
             it->tile[2] != tile[2]) {
@@ -278,6 +282,14 @@ class Tracker {
       // the size of the number of good elements.
       auto size =
           static_cast<std::size_t>(std::distance(tree.begin(), first_bad));
+
+      // If we left a cell, its universe is asked to find where we went, using
+      // the neighbors of that cell. If we changed lattice tile, the search
+      // must start again from the lattice itself.
+      const bool left_cell = first_bad->type == GeoLilyPad::PadType::Cell;
+      const uint32_t previous = first_bad->cell_position;
+      if (first_bad->type == GeoLilyPad::PadType::Lattice) size++;
+
       if (size == 0) return this->restart_get_current();
       tree.resize(size);
 
@@ -286,9 +298,15 @@ class Tracker {
       // that Universe to descend the geometry tree.
       auto uni_indx = universe_id_to_indx[tree.back().id];
       const auto& uni = geometry::universes[uni_indx];
-      Position r_local = tree.back().r_local;
+      Position r_local = local_position(tree.back());
       tree.pop_back();
-      current_cell = uni->get_cell(tree, r_local, u_, surface_token_);
+      tree.set_origin(r_);
+      if (left_cell) {
+        current_cell = uni->get_neighbor_cell(tree, r_local, u_,
+                                              surface_token_, previous);
+      } else {
+        current_cell = uni->get_cell(tree, r_local, u_, surface_token_);
+      }
 
       // If we couldn't get a cell, we need to call in the big guns, and
       // re-start from scratch.
@@ -306,9 +324,7 @@ class Tracker {
   }
 
   bool check_tree() const {
-    return r_.x() == tree.front().r_local.x() &&
-           r_.y() == tree.front().r_local.y() &&
-           r_.z() == tree.front().r_local.z();
+    return !tree.empty() && local_position(tree.front()) == r_;
   }
 
   void do_reflection(Particle& p, Boundary boundary) {
@@ -361,7 +377,12 @@ class Tracker {
  private:
   Position r_;
   Direction u_;
-  std::vector<GeoLilyPad> tree;
+  GeoStack tree;
+  // Total path length travelled by the tracker, used to age cached distances
+  double path_ = 0.;
+  // Incremented every time the direction changes, invalidating the distances
+  // cached in the tree.
+  uint64_t direction_epoch_ = 1;
   Material* current_mat = nullptr;
   UniqueCell current_cell;
   // Token for current surface which particle is on. The index for the
@@ -369,6 +390,83 @@ class Tracker {
   // the surface id !!
   int32_t surface_token_ = 0;
 
+  Position local_position(const GeoLilyPad& pad) const {
+    return r_ + pad.offset;
+  }
+
+  int32_t signed_token(int32_t token, const Position& r_local) const {
+    token = std::abs(token);
+    if (token &&
+        geometry::surfaces[static_cast<std::size_t>(token - 1)]->sign(
+            r_local, u_) < 0)
+      token *= -1;
+    return token;
+  }
+
+  // Makes sure that the cached distances of the level are valid for the
+  // current position and direction, and updates best, the shortest distance
+  // to a boundary found so far. If the safety of the level proves that it
+  // can not contain a boundary closer than best, the level is skipped.
+  void update_distances(GeoLilyPad& pad, double& best) {
+    // Distances along the current direction remain exact as the particle
+    // moves, so we only need to remove the distance which was travelled.
+    // If we are now on the nearest surface of this level, it must be
+    // recomputed however, to find the next one.
+    if (pad.dist_epoch == direction_epoch_) {
+      const double d =
+          std::min(pad.dist, pad.bc_dist) - (path_ - pad.dist_path);
+      if (d > BOUNDRY_TOL) {
+        best = std::min(best, d);
+        return;
+      }
+    }
+
+    if (pad.safety - (path_ - pad.safety_path) > best + BOUNDRY_TOL) {
+      pad.dist_epoch = 0;
+      return;
+    }
+
+    const Position r_local = local_position(pad);
+    if (pad.type == GeoLilyPad::PadType::Cell) {
+      const Cell* cell = geometry::cells[pad.cell_index].get();
+      CellDistances dists = cell->distances(r_local, u_, surface_token_);
+
+      pad.dist = dists.distance;
+      pad.token = signed_token(dists.token, r_local);
+      pad.bc_dist = dists.bc_distance;
+      pad.bc_token = signed_token(dists.bc_token, r_local);
+      pad.safety = dists.safety;
+    } else {
+      auto uni_indx = universe_id_to_indx[pad.id];
+      const Universe* uni = geometry::universes[uni_indx].get();
+
+      pad.dist = INF;
+      pad.token = 0;
+      pad.safety = 0.;
+      if (pad.type == GeoLilyPad::PadType::Lattice) {
+        const Position r_tile = r_local - pad.tile_center;
+        pad.dist = uni->distance_in_tile(r_tile, u_);
+        if (uni->has_boundary_conditions() == false) {
+          pad.safety = uni->safety_in_tile(r_tile);
+        }
+      }
+
+      pad.bc_dist = INF;
+      pad.bc_token = 0;
+      if (uni->has_boundary_conditions()) {
+        Boundary uni_bound =
+            uni->get_boundary_condition(r_local, u_, surface_token_);
+        pad.bc_dist = uni_bound.distance;
+        pad.bc_token = uni_bound.token;
+      }
+    }
+
+    pad.dist_path = path_;
+    pad.dist_epoch = direction_epoch_;
+    pad.safety_path = path_;
+    best = std::min({best, pad.dist, pad.bc_dist});
+  }
+
 };  // Tracker
 
 #endif  // MG_TRACKER_H
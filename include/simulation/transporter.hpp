@@ -31,6 +31,7 @@
 #include <simulation/particle.hpp>
 #include <simulation/tallies.hpp>
 #include <utils/constants.hpp>
+#include <utils/error.hpp>
 #include <utils/rng.hpp>
 #include <utils/settings.hpp>
 
@@ -46,6 +47,10 @@ class Transporter {
       std::vector<BankedParticle>* noise_bank = nullptr,
       const NoiseMaker* noise_maker = nullptr) = 0;
 
+  // Changes the tallies instance which is scored. This is used in noise
+  // simulations, where each noise frequency has its own tallies.
+  void set_tallies(std::shared_ptr<Tallies> i_t) { tallies = i_t; }
+
  protected:
   std::shared_ptr<Tallies> tallies;
 
@@ -58,11 +63,50 @@ class Transporter {
     double mig_score = 0.;
   };
 
+  // Run-mode flags which are fixed for a whole call to transport. The
+  // transport loops of the trackers are templates on a TransportMode, so that
+  // these flags are known at compile time in the innermost loops, and the
+  // branches of the other modes are removed.
+  template <bool NOISE, bool URR, bool BRANCHLESS>
+  struct TransportMode {
+    static constexpr bool noise = NOISE;
+    static constexpr bool urr = URR;
+    static constexpr bool branchless = BRANCHLESS;
+  };
+
+  // Calls f with the TransportMode matching the current settings, and returns
+  // its result. This is where the transport loop of a run is selected.
+  template <typename F>
+  static std::vector<BankedParticle> dispatch_transport(bool noise, F f) {
+    const bool urr = settings::use_urr_ptables;
+    const bool branchless =
+        settings::mode == settings::SimulationMode::BRANCHLESS_K_EIGENVALUE;
+
+    if (noise) {
+      if (branchless) {
+        fatal_error(
+            "Cannot perform noise simulations with branchless collisions.");
+      }
+
+      if (urr) return f(TransportMode<true, true, false>());
+      return f(TransportMode<true, false, false>());
+    }
+
+    if (branchless) {
+      if (urr) return f(TransportMode<false, true, true>());
+      return f(TransportMode<false, false, true>());
+    }
+
+    if (urr) return f(TransportMode<false, true, false>());
+    return f(TransportMode<false, false, false>());
+  }
+
   void russian_roulette(Particle& p);
 
+  template <bool NOISE, bool BRANCHLESS>
   void collision(Particle& p, MaterialHelper& mat,
-                 ThreadLocalScores& thread_scores, bool noise = false,
-                 const NoiseMaker* noise_maker = nullptr);
+                 ThreadLocalScores& thread_scores,
+                 const NoiseMaker* noise_maker);
 
   void branchless_collision(Particle& p, MaterialHelper& mat,
                             ThreadLocalScores& thread_scores);
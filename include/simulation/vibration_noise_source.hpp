@@ -44,7 +44,7 @@ class VibrationNoiseSource : public NoiseSource {
   virtual ~VibrationNoiseSource() = default;
 
   virtual std::complex<double> dN(const Position& r, uint32_t nuclide_id,
-                                  double w) const = 0;
+                                  std::size_t freq) const = 0;
 
   const std::vector<uint32_t>& nuclides() const { return nuclides_; }
 
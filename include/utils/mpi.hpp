@@ -28,7 +28,11 @@
 #include <utils/error.hpp>
 #include <utils/timer.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <source_location>
 #include <vector>
 
@@ -54,6 +58,7 @@ extern const DType Int;
 extern const DType Double;
 extern const DType UInt64;
 extern DType BParticle;
+extern DType BParticleCore;
 
 extern const OpType Sum;
 extern const OpType And;
@@ -84,10 +89,10 @@ inline DType dtype<uint64_t>() {
   return UInt64;
 }
 
+// Only includes the cancellation info of the particles when cancellation
+// is being performed.
 template <>
-inline DType dtype<BankedParticle>() {
-  return BParticle;
-}
+DType dtype<BankedParticle>();
 #endif
 
 extern std::vector<uint64_t> node_nparticles;
@@ -102,6 +107,91 @@ void abort_mpi();
 void synchronize();
 void check_error(int err, const std::source_location& loc);
 
+//==============================================================================
+// Particle Distribution
+
+// Relative speed of each rank, used to decide how many particles each rank
+// is given. When empty, all ranks are given the same number of particles.
+extern std::vector<double> rank_weights;
+
+// Returns the number of values each rank is given when N values are split
+// amongst all ranks, in proportion to rank_weights. The values are always
+// given in rank order, so that history ids stay the same for any split.
+// Tally servers are never given any values.
+std::vector<uint64_t> split(uint64_t N);
+
+// The last settings::tally_servers ranks are tally servers. They transport
+// no particles, and only hold the statistics of slices of the mesh tallies.
+bool is_tally_server();
+int first_tally_server();
+
+// Sets rank_weights from the number of particles that this rank transported
+// and the time it took. Must be called by all ranks.
+void update_rank_weights(
+    uint64_t nparticles, double time,
+    std::source_location loc = std::source_location::current());
+
+//==============================================================================
+// Non-blocking Operations
+
+// Handle to a non-blocking operation, returned by the I* functions. The
+// operation is only complete, and its results only written, once wait has
+// been called. Until then, the vector given to the operation must be kept
+// alive, and may be read but not modified. A request which is still pending
+// is waited on when it is destroyed.
+class Request {
+ public:
+  Request() = default;
+  Request(const Request&) = delete;
+  Request& operator=(const Request&) = delete;
+  Request(Request&& other) noexcept;
+  Request& operator=(Request&& other) noexcept;
+  ~Request();
+
+  bool pending() const { return pending_; }
+
+  void wait(std::source_location loc = std::source_location::current());
+
+#ifdef ABEILLE_USE_MPI
+  // Used by the I* functions to register the MPI requests of an operation,
+  // and what must be done once they are all complete.
+  Request(std::vector<MPI_Request>&& reqs, std::function<void()>&& finish)
+      : reqs_(std::move(reqs)), finish_(std::move(finish)), pending_(true) {}
+#endif
+
+ private:
+#ifdef ABEILLE_USE_MPI
+  std::vector<MPI_Request> reqs_;
+#endif
+  std::function<void()> finish_;
+  bool pending_ = false;
+};
+
+#ifdef ABEILLE_USE_MPI
+// Largest count which can be given to the MPI functions with int counts.
+// Larger transfers use the MPI-4 large-count functions when available, and
+// are otherwise split into point-to-point messages of at most this size.
+constexpr uint64_t MAX_INT_COUNT =
+    static_cast<uint64_t>(std::numeric_limits<int>::max());
+
+// Tag of the point-to-point messages used to split large transfers.
+constexpr int LARGE_COUNT_TAG = 32767;
+
+// Buffers of a non-blocking vector operation, which must live until the
+// operation is complete.
+template <typename T>
+struct VectorOpBuffers {
+  std::vector<T> rcv;
+#if MPI_VERSION >= 4
+  std::vector<MPI_Count> counts;
+  std::vector<MPI_Aint> disps;
+#else
+  std::vector<int> counts;
+  std::vector<int> disps;
+#endif
+};
+#endif
+
 //==============================================================================
 // MPI Operations
 template <typename T>
@@ -163,6 +253,36 @@ void Send(std::vector<T>& vals, int dest, int tag = 0,
 #endif
 }
 
+// Starts sending vals to dest, so that they may be received with Recv. The
+// number of values is sent first, and vals must not be modified until the
+// request has been waited on.
+template <typename T>
+Request Isend(std::vector<T>& vals, int dest, int tag = 0,
+              std::source_location loc = std::source_location::current()) {
+  if (size < 2) {
+    fatal_error("mpi::Isend cannot be called with mpi::size less than 2", loc);
+  }
+#ifdef ABEILLE_USE_MPI
+  timer.start();
+  std::size_t count = vals.size();
+  Send(count, dest, tag++);
+
+  std::vector<MPI_Request> reqs(1);
+  int err = MPI_Isend(vals.data(), static_cast<int>(count), dtype<T>(), dest,
+                      tag, com, &reqs.back());
+  check_error(err, loc);
+  timer.stop();
+
+  return Request(std::move(reqs), nullptr);
+#else
+  (void)vals;
+  (void)dest;
+  (void)tag;
+  (void)loc;
+  return Request();
+#endif
+}
+
 template <typename T>
 void Recv(T& val, int src, int tag = 0,
           std::source_location loc = std::source_location::current()) {
@@ -288,109 +408,263 @@ void Reduce_sum(std::vector<T>& vals, int root,
 #endif
 }
 
+// Starts summing the values of all ranks on root. Once the request has been
+// waited on, vals holds the sums on root, and is unchanged on the other
+// ranks. The sum is done in place on root, so no extra copy is allocated.
 template <typename T>
-void Gatherv(std::vector<T>& vals, int root,
-             std::source_location loc = std::source_location::current()) {
+Request Ireduce_sum(
+    std::vector<T>& vals, int root,
+    std::source_location loc = std::source_location::current()) {
 #ifdef ABEILLE_USE_MPI
   if (size > 1) {
     timer.start();
-    // First, we need to know how many things each rank has
-    std::vector<int> sizes(static_cast<std::size_t>(size), 0);
-    sizes[static_cast<std::size_t>(rank)] = static_cast<int>(vals.size());
-    for (std::size_t n = 0; n < static_cast<std::size_t>(size); n++) {
-      Bcast<int>(sizes[n], static_cast<int>(n));
+    const void* send = rank == root ? MPI_IN_PLACE : vals.data();
+    std::vector<MPI_Request> reqs;
+    int err = MPI_SUCCESS;
+#if MPI_VERSION >= 4
+    reqs.emplace_back();
+    err = MPI_Ireduce_c(send, vals.data(), static_cast<MPI_Count>(vals.size()),
+                        dtype<T>(), Sum, root, com, &reqs.back());
+    check_error(err, loc);
+#else
+    // Too many values for int counts are summed in several reductions
+    for (uint64_t offset = 0; offset < vals.size(); offset += MAX_INT_COUNT) {
+      const int count =
+          static_cast<int>(std::min(MAX_INT_COUNT, vals.size() - offset));
+      const void* send_chunk =
+          rank == root ? MPI_IN_PLACE : vals.data() + offset;
+      reqs.emplace_back();
+      err = MPI_Ireduce(send_chunk, vals.data() + offset, count, dtype<T>(),
+                        Sum, root, com, &reqs.back());
+      check_error(err, loc);
     }
+    (void)send;
+#endif
+    timer.stop();
+
+    return Request(std::move(reqs), nullptr);
+  }
+#else
+  (void)vals;
+  (void)root;
+  (void)loc;
+#endif
+  return Request();
+}
+
+template <typename T>
+void Allgather(const T& val, std::vector<T>& vals,
+               std::source_location loc = std::source_location::current()) {
+  vals.resize(static_cast<std::size_t>(size));
+#ifdef ABEILLE_USE_MPI
+  if (size > 1) {
+    timer.start();
+    int err = MPI_Allgather(&val, 1, dtype<T>(), vals.data(), 1, dtype<T>(),
+                            com);
+    check_error(err, loc);
+    timer.stop();
+    return;
+  }
+#endif
+  vals[0] = val;
+  (void)loc;
+}
+
+// Starts gathering the values of all ranks on root, in rank order. Once the
+// request has been waited on, vals holds all of the values on root, and is
+// empty on the other ranks.
+template <typename T>
+Request Igatherv(std::vector<T>& vals, int root,
+                 std::source_location loc = std::source_location::current()) {
+#ifdef ABEILLE_USE_MPI
+  if (size > 1) {
+    // First, we need to know how many things each rank has
+    std::vector<uint64_t> sizes;
+    Allgather<uint64_t>(vals.size(), sizes, loc);
 
+    timer.start();
     // Now that we know how many items each node has, we can determine the
     // displacements
-    std::vector<int> disps(static_cast<std::size_t>(size), 0);
-    int disps_counter = 0;
-    for (std::size_t n = 0; n < static_cast<std::size_t>(size); n++) {
-      disps[n] = disps_counter;
-      disps_counter += sizes[n];
+    const std::size_t nranks = static_cast<std::size_t>(size);
+    std::vector<uint64_t> disps(nranks, 0);
+    uint64_t Ntot = 0;
+    for (std::size_t n = 0; n < nranks; n++) {
+      disps[n] = Ntot;
+      Ntot += sizes[n];
     }
 
-    // Temporary vector to recieve result on the root
-    std::vector<T> tmp_rcv;
-    if (rank == root) {
-      std::size_t Ntot = 0;
-      for (std::size_t n = 0; n < static_cast<std::size_t>(size); n++) {
-        Ntot += static_cast<std::size_t>(sizes[n]);
-      }
-      tmp_rcv.resize(Ntot);
-    }
-
-    // Do the Gatherv
-    int err =
-        MPI_Gatherv(&vals[0], static_cast<int>(vals.size()), dtype<T>(),
-                    &tmp_rcv[0], &sizes[0], &disps[0], dtype<T>(), root, com);
+    // Buffer to recieve result on the root
+    auto bufs = std::make_shared<VectorOpBuffers<T>>();
+    if (rank == root) bufs->rcv.resize(Ntot);
+    bufs->counts.assign(sizes.begin(), sizes.end());
+    bufs->disps.assign(disps.begin(), disps.end());
+
+    std::vector<MPI_Request> reqs;
+    int err = MPI_SUCCESS;
+#if MPI_VERSION >= 4
+    reqs.emplace_back();
+    err = MPI_Igatherv_c(vals.data(), static_cast<MPI_Count>(vals.size()),
+                         dtype<T>(), bufs->rcv.data(), bufs->counts.data(),
+                         bufs->disps.data(), dtype<T>(), root, com,
+                         &reqs.back());
     check_error(err, loc);
-
-    if (rank == root) {
-      vals.swap(tmp_rcv);
+#else
+    if (Ntot <= MAX_INT_COUNT) {
+      reqs.emplace_back();
+      err = MPI_Igatherv(vals.data(), static_cast<int>(vals.size()),
+                         dtype<T>(), bufs->rcv.data(), bufs->counts.data(),
+                         bufs->disps.data(), dtype<T>(), root, com,
+                         &reqs.back());
+      check_error(err, loc);
+    } else if (rank == root) {
+      // Too many values for int counts. Receive the values of each rank in
+      // chunks, and copy our own directly.
+      for (std::size_t n = 0; n < nranks; n++) {
+        if (static_cast<int>(n) == root) {
+          std::copy(vals.begin(), vals.end(), bufs->rcv.begin() + disps[n]);
+          continue;
+        }
+
+        for (uint64_t offset = 0; offset < sizes[n]; offset += MAX_INT_COUNT) {
+          const int count =
+              static_cast<int>(std::min(MAX_INT_COUNT, sizes[n] - offset));
+          reqs.emplace_back();
+          err = MPI_Irecv(bufs->rcv.data() + disps[n] + offset, count,
+                          dtype<T>(), static_cast<int>(n), LARGE_COUNT_TAG,
+                          com, &reqs.back());
+          check_error(err, loc);
+        }
+      }
     } else {
-      vals.clear();
+      const uint64_t my_size = vals.size();
+      for (uint64_t offset = 0; offset < my_size; offset += MAX_INT_COUNT) {
+        const int count =
+            static_cast<int>(std::min(MAX_INT_COUNT, my_size - offset));
+        reqs.emplace_back();
+        err = MPI_Isend(vals.data() + offset, count, dtype<T>(), root,
+                        LARGE_COUNT_TAG, com, &reqs.back());
+        check_error(err, loc);
+      }
     }
+#endif
     timer.stop();
+
+    return Request(std::move(reqs), [&vals, bufs, root]() {
+      if (rank == root) {
+        vals.swap(bufs->rcv);
+      } else {
+        vals.clear();
+      }
+    });
   }
 #else
   (void)vals;
   (void)root;
   (void)loc;
 #endif
+  return Request();
 }
 
+// Starts scattering the values on root to all ranks, in rank order, with
+// the number of values on each rank given by split. Once the request has
+// been waited on, vals holds the values of this rank.
 template <typename T>
-void Scatterv(std::vector<T>& vals, int root,
-              std::source_location loc = std::source_location::current()) {
+Request Iscatterv(std::vector<T>& vals, int root,
+                  std::source_location loc = std::source_location::current()) {
 #ifdef ABEILLE_USE_MPI
   if (size > 1) {
-    timer.start();
     // First, we need to know how many values there are on root to send,
     // and then how many values each node should get
     uint64_t Ntot = vals.size();
-    Bcast<uint64_t>(Ntot, root);
-
-    const int base = static_cast<int>(Ntot) / size;
-    const int remainder = static_cast<int>(Ntot) - (size * base);
-
-    std::vector<int> sizes(static_cast<std::size_t>(size), 0);
-    for (std::size_t n = 0; n < static_cast<std::size_t>(size); n++) {
-      sizes[n] = base;
-      if (static_cast<int>(n) < remainder) sizes[n]++;
-    }
-
-    // Now we calculate the displacements if we are root
-    std::vector<int> disps;
-    if (rank == root) {
-      disps.resize(static_cast<std::size_t>(size), 0);
+    Bcast<uint64_t>(Ntot, root, loc);
 
-      int disps_counter = 0;
-      for (std::size_t n = 0; n < static_cast<std::size_t>(size); n++) {
-        disps[n] = disps_counter;
-        disps_counter += sizes[n];
-      }
+    timer.start();
+    const std::size_t nranks = static_cast<std::size_t>(size);
+    std::vector<uint64_t> sizes = split(Ntot);
+    std::vector<uint64_t> disps(nranks, 0);
+    uint64_t disps_counter = 0;
+    for (std::size_t n = 0; n < nranks; n++) {
+      disps[n] = disps_counter;
+      disps_counter += sizes[n];
     }
+    const uint64_t my_size = sizes[static_cast<std::size_t>(rank)];
 
     // Make a receiving buffer
-    std::vector<T> tmp_rcv;
-    tmp_rcv.resize(
-        static_cast<std::size_t>(sizes[static_cast<std::size_t>(rank)]));
-
-    // Do the Scatterv
-    int err = MPI_Scatterv(&vals[0], &sizes[0], &disps[0], dtype<T>(),
-                           &tmp_rcv[0], sizes[static_cast<std::size_t>(rank)],
-                           dtype<T>(), root, com);
+    auto bufs = std::make_shared<VectorOpBuffers<T>>();
+    bufs->rcv.resize(my_size);
+    bufs->counts.assign(sizes.begin(), sizes.end());
+    bufs->disps.assign(disps.begin(), disps.end());
+
+    std::vector<MPI_Request> reqs;
+    int err = MPI_SUCCESS;
+#if MPI_VERSION >= 4
+    reqs.emplace_back();
+    err = MPI_Iscatterv_c(vals.data(), bufs->counts.data(), bufs->disps.data(),
+                          dtype<T>(), bufs->rcv.data(),
+                          static_cast<MPI_Count>(my_size), dtype<T>(), root,
+                          com, &reqs.back());
     check_error(err, loc);
-
-    vals = tmp_rcv;
+#else
+    if (Ntot <= MAX_INT_COUNT) {
+      reqs.emplace_back();
+      err = MPI_Iscatterv(vals.data(), bufs->counts.data(), bufs->disps.data(),
+                          dtype<T>(), bufs->rcv.data(),
+                          static_cast<int>(my_size), dtype<T>(), root, com,
+                          &reqs.back());
+      check_error(err, loc);
+    } else if (rank == root) {
+      // Too many values for int counts. Send the values of each rank in
+      // chunks, and copy our own directly.
+      for (std::size_t n = 0; n < nranks; n++) {
+        if (static_cast<int>(n) == root) {
+          std::copy(vals.begin() + disps[n],
+                    vals.begin() + disps[n] + sizes[n], bufs->rcv.begin());
+          continue;
+        }
+
+        for (uint64_t offset = 0; offset < sizes[n]; offset += MAX_INT_COUNT) {
+          const int count =
+              static_cast<int>(std::min(MAX_INT_COUNT, sizes[n] - offset));
+          reqs.emplace_back();
+          err = MPI_Isend(vals.data() + disps[n] + offset, count, dtype<T>(),
+                          static_cast<int>(n), LARGE_COUNT_TAG, com,
+                          &reqs.back());
+          check_error(err, loc);
+        }
+      }
+    } else {
+      for (uint64_t offset = 0; offset < my_size; offset += MAX_INT_COUNT) {
+        const int count =
+            static_cast<int>(std::min(MAX_INT_COUNT, my_size - offset));
+        reqs.emplace_back();
+        err = MPI_Irecv(bufs->rcv.data() + offset, count, dtype<T>(), root,
+                        LARGE_COUNT_TAG, com, &reqs.back());
+        check_error(err, loc);
+      }
+    }
+#endif
     timer.stop();
+
+    return Request(std::move(reqs), [&vals, bufs]() { vals.swap(bufs->rcv); });
   }
 #else
   (void)vals;
   (void)root;
   (void)loc;
 #endif
+  return Request();
+}
+
+template <typename T>
+void Gatherv(std::vector<T>& vals, int root,
+             std::source_location loc = std::source_location::current()) {
+  Igatherv(vals, root, loc).wait(loc);
+}
+
+template <typename T>
+void Scatterv(std::vector<T>& vals, int root,
+              std::source_location loc = std::source_location::current()) {
+  Iscatterv(vals, root, loc).wait(loc);
 }
 
 }  // namespace mpi
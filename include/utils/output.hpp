@@ -31,13 +31,17 @@
 #include <highfive/H5File.hpp>
 namespace H5 = HighFive;
 
+#include <condition_variable>
 #include <ctime>
+#include <deque>
+#include <functional>
 #include <iostream>
 #include <memory>
 #include <mutex>
 #include <optional>
 #include <source_location>
 #include <string>
+#include <thread>
 #include <vector>
 
 //============================================================================
@@ -49,7 +53,7 @@ class Output {
   Output(Output&&) = delete;
   Output& operator=(const Output&) = delete;
   Output& operator=(Output&&) = delete;
-  ~Output() = default;
+  ~Output();
 
   static void set_output_filename(const std::string& fname);
 
@@ -71,9 +75,22 @@ class Output {
   void write_error(const std::string& message);
 
   // Only master (i.e. mpi::rank == 0) can call this method without error !
+  // All queued background writes are finished before the file is returned.
   H5::File& h5(
       const std::source_location& loc = std::source_location::current());
 
+  // Queues a job which writes to the output file on a background thread, so
+  // that the caller may continue. nbytes is the memory held by the job. When
+  // the queued jobs hold more than the stream queue size, this blocks until
+  // the writer has caught up. Only master writes, so this does nothing on
+  // the other nodes.
+  void write_async(std::function<void(H5::File&)> job, std::size_t nbytes);
+
+  // Blocks until all queued background writes are finished. HDF5 is not
+  // thread safe, so this must be called before using HDF5 for anything other
+  // than the output file while writes may be queued.
+  void wait_for_writes();
+
  private:
   Output();
   static std::string output_filename;
@@ -82,10 +99,34 @@ class Output {
   std::vector<std::string> warnings_for_latter;
   std::mutex write_mutex;
   std::mutex save_mutex;
+
+  // Background writer
+  struct WriteJob {
+    std::function<void(H5::File&)> job;
+    std::size_t nbytes;
+  };
+  std::deque<WriteJob> write_queue;
+  std::size_t queued_bytes = 0;
+  bool writing = false;
+  bool stop_writer = false;
+  std::string writer_error;
+  std::mutex queue_mutex;
+  std::condition_variable queue_cv;
+  std::thread writer;
+
+  void writer_loop();
 };  // Output
 
 //============================================================================
 // Non-Member Functions for Output
+
+// Appends one row, of shape row_shape, to a dataset of the output file. The
+// dataset is created on the first call, with an unlimited number of rows.
+// This is meant to be used from the jobs given to Output::write_async.
+void append_row(H5::File& h5, const std::string& name,
+                const std::vector<double>& row,
+                const std::vector<std::size_t>& row_shape = {});
+
 void print_header();
 
 std::string current_date_time();
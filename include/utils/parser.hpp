@@ -51,6 +51,7 @@ extern std::map<uint32_t, size_t> universe_id_to_indx;
 extern std::vector<std::shared_ptr<Source>> sources;
 extern NoiseMaker noise_maker;
 extern std::shared_ptr<Tallies> tallies;
+extern std::vector<std::shared_ptr<Tallies>> frequency_tallies;
 extern std::shared_ptr<Transporter> transporter;
 extern std::shared_ptr<Simulation> simulation;
 extern std::shared_ptr<Cancelator> cancelator;
@@ -82,6 +82,7 @@ extern double wgt_survival;
 extern double wgt_split;
 
 extern double w_noise;
+extern std::vector<double> noise_frequencies;
 extern double eta;
 extern double keff;
 
@@ -93,13 +94,36 @@ extern bool pair_distance_sqrd;
 extern bool families;
 extern bool empty_entropy_bins;
 
+extern bool adaptive_distribution;
+
 extern bool regional_cancellation;
 extern bool regional_cancellation_noise;
 extern bool inner_generations;
 extern bool normalize_noise_source;
 extern bool rng_stride_warnings;
+extern bool flatten_geometry;
 extern bool load_source_file;
 
+// Layout of the written source
+extern bool source_float32;
+extern int source_compression;
+
+// Checkpoints, and restarting from them
+extern int checkpoint_interval;
+extern std::string checkpoint_file_name;
+extern bool restart;
+extern std::string restart_file_name;
+
+// Streaming of per-generation results to the output file
+extern bool stream_generations;
+extern int stream_queue_size;  // In MB
+
+// Number of generations in each batch of the mesh tallies
+extern int tally_batch_size;
+
+// Number of MPI ranks which only hold the mesh tally statistics
+extern int tally_servers;
+
 // Branchless PI settings
 extern bool branchless_splitting;
 extern bool branchless_combing;
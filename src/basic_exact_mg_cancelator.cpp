@@ -316,40 +316,71 @@ void BasicExactMGCancelator::get_averages(const Key& key, Material* mat,
   }
 }
 
-void BasicExactMGCancelator::get_averages_sobol(const Key& key, Material* mat,
-                                                CancelBin& bin) {
-  // Make sure vectors are allocated
-  bin.averages.resize(bin.particles.size());
+void BasicExactMGCancelator::build_sample_set(const Key& key, Material* mat,
+                                              SampleSet& samples) const {
+  samples.built = true;
+  samples.valid = false;
+  samples.x.reserve(N_SAMPLES);
+  samples.y.reserve(N_SAMPLES);
+  samples.z.reserve(N_SAMPLES);
 
-  // Get all positions
-  std::vector<Position> r_smps;
-  r_smps.reserve(N_SAMPLES);
   unsigned long long sobol_index = 0;
   for (std::size_t j = 0; j < N_SAMPLES; j++) {
     std::optional<Position> r_smp =
         sample_position_sobol(key, mat, sobol_index);
     if (r_smp) {
-      r_smps.push_back(r_smp.value());
+      samples.x.push_back(r_smp->x());
+      samples.y.push_back(r_smp->y());
+      samples.z.push_back(r_smp->z());
     } else {
-      // We couldn't sample a point, so we just wont cancel
-      // this bin.
-      bin.can_cancel = false;
+      // We couldn't sample a point, so this bin will never be cancelled.
+      samples = SampleSet();
+      samples.built = true;
       return;
     }
   }
 
+  samples.valid = true;
+}
+
+void BasicExactMGCancelator::get_averages_sobol(const Key& key, Material* mat,
+                                                CancelBin& bin,
+                                                SampleSet& samples) {
+  // Make sure vectors are allocated
+  bin.averages.resize(bin.particles.size());
+
+  // Get all positions. These are only sampled once per bin.
+  if (!samples.built) build_sample_set(key, mat, samples);
+  if (!samples.valid) {
+    // We couldn't sample a point, so we just wont cancel
+    // this bin.
+    bin.can_cancel = false;
+    return;
+  }
+  const double* x = samples.x.data();
+  const double* y = samples.y.data();
+  const double* z = samples.z.data();
+  const std::size_t N = samples.size();
+
   // Go through all particles
   for (std::size_t i = 0; i < bin.particles.size(); i++) {
-    Position r_parent = bin.particles[i]->parents_previous_position;
-    double E = bin.particles[i]->parents_previous_energy;
-    double Esmp = bin.particles[i]->Esmp_parent;
-    MaterialHelper mat_helper(mat, E);
+    const Position& r_parent = bin.particles[i]->parents_previous_position;
+    const double xp = r_parent.x(), yp = r_parent.y(), zp = r_parent.z();
+    const double Esmp = bin.particles[i]->Esmp_parent;
 
-    // Compute the average value for f and 1/f
+    // Compute the average value for f and 1/f. This is the same f as in
+    // get_f, written out so that the loop can be vectorized.
     double sum_f = 0.;
     double sum_f_inv = 0.;
-    for (const auto& r_smp : r_smps) {
-      double f = get_f(r_smp, r_parent, Esmp);
+#ifdef ABEILLE_USE_OMP
+#pragma omp simd reduction(+ : sum_f, sum_f_inv)
+#endif
+    for (std::size_t j = 0; j < N; j++) {
+      const double dx = x[j] - xp;
+      const double dy = y[j] - yp;
+      const double dz = z[j] - zp;
+      const double d2 = dx * dx + dy * dy + dz * dz;
+      const double f = std::exp(-Esmp * std::sqrt(d2)) / d2;
       sum_f += f;
       sum_f_inv += 1. / f;
     }
@@ -472,6 +503,13 @@ void BasicExactMGCancelator::perform_cancellation(pcg32& rng) {
       keys.push_back({key, mat_bin_pair.first});
   }
 
+  // Make sure every bin has an entry for its Sobol points, so that the
+  // sobol_samples map isn't modified inside the parallel loop.
+  if (use_sobol) {
+    for (const auto& key_mat : keys)
+      sobol_samples[key_mat.first].try_emplace(key_mat.second);
+  }
+
   // Get seed offsets to try and make parallel cancellation
   // deterministic (i.e. independent of the number of threads)
   uint64_t seed_advance = 0;
@@ -528,7 +566,7 @@ void BasicExactMGCancelator::perform_cancellation(pcg32& rng) {
           (beta_mode == BetaMode::OptAverageF ||
            beta_mode == BetaMode::OptAverageGain)) {
         if (use_sobol) {
-          get_averages_sobol(key, mat, bin);
+          get_averages_sobol(key, mat, bin, sobol_samples[key][mat]);
         } else {
           get_averages(key, mat, bin, rng_local);
         }
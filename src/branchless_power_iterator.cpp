@@ -31,9 +31,6 @@
 #include <utils/settings.hpp>
 #include <utils/timer.hpp>
 
-#include <highfive/H5File.hpp>
-namespace H5 = HighFive;
-
 #include <cmath>
 #include <fstream>
 #include <iomanip>
@@ -58,97 +55,14 @@ void BranchlessPowerIterator::initialize() {
 }
 
 void BranchlessPowerIterator::load_source_from_file() {
-  // Load source file
-  auto h5s = H5::File(settings::in_source_file_name, H5::File::ReadOnly);
-
-  // Get the dataset and dimensions
-  auto source_ds = h5s.getDataSet("source");
-  std::vector<std::size_t> dimensions = source_ds.getSpace().getDimensions();
-
-  // Check dimensions
-  if (dimensions.size() != 2 || dimensions[1] != 9) {
-    fatal_error("Invalid source from file dimensions.");
-  }
-
-  // Read in array
-  NDArray<double> source = NDArray<double>(dimensions);
-  source_ds.read<double>(&source[0]);
-
-  // Get number of particles
-  std::size_t Nprt = source.shape()[0];
-
-  // Calculate the base number of particles per node to run
-  uint64_t base_particles_per_node =
-      static_cast<uint64_t>(Nprt / static_cast<uint64_t>(mpi::size));
-  uint64_t remainder =
-      static_cast<uint64_t>(Nprt % static_cast<uint64_t>(mpi::size));
-
-  // Set the base number of particles per node in the node_nparticles vector
-  mpi::node_nparticles.resize(static_cast<std::size_t>(mpi::size),
-                              base_particles_per_node);
-
-  // Distribute the remainder particles amonst the nodes. There are at most
-  // mpi::size-1 remainder particles, so we will distribute them untill we
-  // have no more.
-  for (std::size_t rank = 0; rank < remainder; rank++) {
-    mpi::node_nparticles[rank]++;
-  }
-
-  // Now we need to make sure that the history_counter for each node is at
-  // the right starting location.
-  for (int lower_rank = 0; lower_rank < mpi::rank; lower_rank++) {
-    histories_counter +=
-        mpi::node_nparticles.at(static_cast<std::size_t>(lower_rank));
-  }
-
-  // Each node starts reading the input source data at their histories_counter
-  // index. It then reads its assigned number of particles.
-  uint64_t file_start_loc = histories_counter;
-  double tot_wgt = 0.;
-  for (std::size_t i = 0;
-       i < mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)]; i++) {
-    double x = source[(file_start_loc + i) * 9 + 0];
-    double y = source[(file_start_loc + i) * 9 + 1];
-    double z = source[(file_start_loc + i) * 9 + 2];
-    double ux = source[(file_start_loc + i) * 9 + 3];
-    double uy = source[(file_start_loc + i) * 9 + 4];
-    double uz = source[(file_start_loc + i) * 9 + 5];
-    double E = source[(file_start_loc + i) * 9 + 6];
-    double w = source[(file_start_loc + i) * 9 + 7];
-    double w2 = source[(file_start_loc + i) * 9 + 8];
-
-    bank.push_back({{x, y, z}, {ux, uy, uz}, E, w, histories_counter++});
-    bank.back().set_weight2(w2);
-    bank.back().initialize_rng(settings::rng_seed, settings::rng_stride);
-    tot_wgt += w;
-  }
-  global_histories_counter = Nprt;
-
-  mpi::Allreduce_sum(tot_wgt);
-
-  Output::instance().write(
-      " Total Weight of System: " + std::to_string(std::round(tot_wgt)) + "\n");
-  settings::nparticles = static_cast<int>(std::round(tot_wgt));
-  tallies->set_total_weight(std::round(tot_wgt));
+  load_source_file(bank);
 }
 
 void BranchlessPowerIterator::sample_source_from_sources() {
   Output::instance().write(" Generating source particles...\n");
-  // Calculate the base number of particles per node to run
-  uint64_t base_particles_per_node =
-      static_cast<uint64_t>(settings::nparticles / mpi::size);
-  uint64_t remainder = static_cast<uint64_t>(settings::nparticles % mpi::size);
-
-  // Set the base number of particles per node in the node_nparticles vector
-  mpi::node_nparticles.resize(static_cast<uint64_t>(mpi::size),
-                              base_particles_per_node);
-
-  // Distribute the remainder particles amonst the nodes. There are at most
-  // mpi::size-1 remainder particles, so we will distribute them untill we
-  // have no more.
-  for (std::size_t rank = 0; rank < remainder; rank++) {
-    mpi::node_nparticles[rank]++;
-  }
+  // Calculate the number of particles per node to run
+  mpi::node_nparticles =
+      mpi::split(static_cast<uint64_t>(settings::nparticles));
 
   // Now we need to make sure that the history_counter for each node is at
   // the right starting location.
@@ -330,13 +244,25 @@ void BranchlessPowerIterator::run() {
       for (auto& p : bank) families.insert(p.family_id());
     }
 
+    // The bank is cleared by the transport, so the number of particles is
+    // kept for the rank weights.
+    const uint64_t nprt = bank.size();
+    transport_timer.reset();
+    transport_timer.start();
     std::vector<BankedParticle> next_gen = transporter->transport(bank);
+    transport_timer.stop();
     transported_histories += bank.size();
+    update_rank_weights(nprt);
 
     if (next_gen.size() == 0) {
       fatal_error("No fission neutrons were produced.");
     }
 
+    // Start sending all particles to master for cancellation and
+    // normalization/combing. The pre-cancellation entropy and the new keff
+    // are computed while the particles are in flight.
+    mpi::Request to_master = particles_to_master(next_gen);
+
     // Do all Pre-Cancelation entropy calculations
     compute_pre_cancellation_entropy(next_gen);
 
@@ -345,10 +271,7 @@ void BranchlessPowerIterator::run() {
 
     // std::sort(next_gen.begin(), next_gen.end()); // This shouldn't be
     // necessary, as fission progeny should naturally be sorted
-    mpi::synchronize();
-
-    // Send all particles to master for cancellation and normalization/combing
-    particles_to_master(next_gen);
+    to_master.wait();
 
     // Do weight cancelation
     if (settings::regional_cancellation && cancelator && mpi::rank == 0) {
@@ -411,6 +334,7 @@ void BranchlessPowerIterator::run() {
 
     // Output
     generation_output();
+    stream_entropy();
 
     // Check if signal has been sent after generation keff has been
     // recorded, and cancellation has occured. Otherwize source file
@@ -92,6 +92,15 @@ CarterTracker::CarterTracker(std::shared_ptr<Tallies> i_t)
 std::vector<BankedParticle> CarterTracker::transport(
     std::vector<Particle>& bank, bool noise,
     std::vector<BankedParticle>* noise_bank, const NoiseMaker* noise_maker) {
+  return dispatch_transport(noise, [&](auto mode) {
+    return transport_particles<decltype(mode)>(bank, noise_bank, noise_maker);
+  });
+}
+
+template <typename Mode>
+std::vector<BankedParticle> CarterTracker::transport_particles(
+    std::vector<Particle>& bank, std::vector<BankedParticle>* noise_bank,
+    const NoiseMaker* noise_maker) {
 #ifdef ABEILLE_USE_OMP
 #pragma omp parallel
 #endif
@@ -119,14 +128,15 @@ std::vector<BankedParticle> CarterTracker::transport(
       // Only make helper if we aren't lost, to make sure that material isn't
       // a nullptr
       MaterialHelper mat(trkr.material(), p.E());
-      if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+      if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
 
       // auto bound = trkr.boundary();
       while (p.is_alive()) {
         bool had_collision = false;
         bool crossed_boundary = false;
         auto maj_indx = EGrid->get_lower_index(p.E());
-        double Esample = Esmp->evaluate(p.E(), maj_indx) + mat.Ew(p.E(), noise);
+        double Esample =
+            Esmp->evaluate(p.E(), maj_indx) + mat.Ew(p.E(), Mode::noise);
         p.set_Esmp(Esample);  // Sampling XS saved for cancellation
         double d_coll = RNG::exponential(p.rng, Esample);
         Boundary bound(INF, -1, BoundaryType::Normal);
@@ -187,7 +197,7 @@ std::vector<BankedParticle> CarterTracker::transport(
           mat.set_material(trkr.material(), p.E());
 
           // Get true cross section here
-          double Et = mat.Et(p.E(), noise);
+          double Et = mat.Et(p.E(), Mode::noise);
 
           if (Esample >= Et) {
             if (RNG::rand(p.rng) < (Et / Esample)) {
@@ -208,10 +218,11 @@ std::vector<BankedParticle> CarterTracker::transport(
         }
 
         if (p.is_alive() && had_collision) {  // real collision
-          collision(p, mat, thread_scores, noise, noise_maker);
+          collision<Mode::noise, Mode::branchless>(p, mat, thread_scores,
+                                                 noise_maker);
           trkr.set_u(p.u());
           p.set_previous_collision_real();
-          if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+          if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
         } else if (p.is_alive()) {
           p.set_previous_collision_virtual();
         }
@@ -241,7 +252,7 @@ std::vector<BankedParticle> CarterTracker::transport(
             }
             bound = trkr.get_boundary_condition();
             mat.set_material(trkr.material(), p.E());
-            if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+            if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
           } else if (settings::rng_stride_warnings) {
             // History is truly dead.
             // Check if we went past the particle stride.
@@ -141,6 +141,45 @@ std::pair<double, int32_t> Cell::distance_to_boundary_condition(
   return {min_dist, i_surf};
 }
 
+CellDistances Cell::distances(const Position& r, const Direction& u,
+                             int32_t on_surf) const {
+  CellDistances dists;
+
+  for (int32_t token : rpn) {
+    // Ignore this token if it corresponds to an operator rather than a region.
+    if (token >= OP::UNIN) continue;
+
+    // Calculate the distance to this surface.
+    // Note the off-by-one indexing
+    bool coincident = std::abs(token) == std::abs(on_surf);
+    const Surface* surf =
+        geometry::surfaces[static_cast<std::size_t>(abs(token) - 1)].get();
+    double d = surf->distance(r, u, coincident);
+
+    // Check if this distance is the new minimum.
+    if (d < dists.distance) {
+      if (std::abs(d - dists.distance) / dists.distance >= 1e-14) {
+        dists.distance = d;
+        dists.token = -token;
+      }
+    }
+
+    // Vacuum and reflective surfaces are also tracked separately
+    if (vacuum_or_reflective_ && surf->boundary() != BoundaryType::Normal &&
+        d < dists.bc_distance) {
+      if (std::abs(d - dists.bc_distance) / dists.bc_distance >= 1e-14) {
+        dists.bc_distance = d;
+        dists.bc_token = -token;
+      }
+    }
+
+    const double s = surf->safety(r);
+    if (s < dists.safety) dists.safety = s;
+  }
+
+  return dists;
+}
+
 bool Cell::is_inside_simple(const Position& r, const Direction& u,
                             int32_t on_surf) const {
   for (const int32_t& token : rpn) {
@@ -219,6 +258,36 @@ void Cell::check_for_bc() {
   }
 }
 
+std::shared_ptr<Cell> Cell::restricted_to(const Cell& outer) const {
+  auto cell = std::make_shared<Cell>(*this);
+
+  if (outer.rpn.empty()) return cell;
+
+  if (rpn.empty()) {
+    cell->rpn = outer.rpn;
+  } else {
+    cell->rpn = rpn_expression();
+    std::vector<int32_t> outer_rpn = outer.rpn_expression();
+    cell->rpn.insert(cell->rpn.end(), outer_rpn.begin(), outer_rpn.end());
+    cell->rpn.push_back(OP::INTR);
+  }
+
+  cell->simplify();
+  cell->check_for_bc();
+  return cell;
+}
+
+std::vector<int32_t> Cell::rpn_expression() const {
+  std::vector<int32_t> expr = rpn;
+
+  // Simple cells are only a list of half-spaces, all of which are intersected
+  if (simple) {
+    for (std::size_t i = 1; i < rpn.size(); i++) expr.push_back(OP::INTR);
+  }
+
+  return expr;
+}
+
 void Cell::simplify() {
   // Check if simple or not
   simple = true;
@@ -27,9 +27,14 @@
 #include <geometry/geometry.hpp>
 #include <utils/error.hpp>
 
+#include <algorithm>
+
 CellUniverse::CellUniverse(std::vector<uint32_t> i_ind, uint32_t i_id,
                            std::string i_name)
-    : Universe{i_id, i_name}, cell_indicies{i_ind} {
+    : Universe{i_id, i_name},
+      cell_indicies{i_ind},
+      neighbors(std::make_unique<std::atomic<uint64_t>[]>(cell_indicies.size() *
+                                                          NEIGHBOR_SLOTS)) {
   this->has_boundary_conditions_ = false;
   for (auto& indx : cell_indicies) {
     Cell* cell = geometry::cells[indx].get();
@@ -69,45 +74,107 @@ UniqueCell CellUniverse::get_cell(Position r, Direction u,
   return ucell;
 }
 
-UniqueCell CellUniverse::get_cell(std::vector<GeoLilyPad>& stack, Position r,
-                                  Direction u, int32_t on_surf) const {
+UniqueCell CellUniverse::get_cell(GeoStack& stack, Position r, Direction u,
+                                  int32_t on_surf) const {
   // First push universe info onto the stack
   stack.push_back({GeoLilyPad::PadType::Universe, id_, r, {0, 0, 0}, false});
 
-  UniqueCell ucell;
-
   // Go through each cell, and return the first one for which the
   // given position is inside the cell
   for (std::size_t i = 0; i < cell_indicies.size(); i++) {
     const auto& indx = cell_indicies[i];
 
     if (geometry::cells[indx]->is_inside(r, u, on_surf)) {
-      auto cell_id = geometry::cells[indx]->id();
+      return enter_cell(stack, i, r, u, on_surf);
+    }
+  }
 
-      // Save stack data for cell
-      stack.push_back(
-          {GeoLilyPad::PadType::Cell, cell_id, r, {0, 0, 0}, false});
+  // No cell found, particle is lost
+  return UniqueCell();
+}
 
-      Cell* cell = geometry::cells[indx].get();
+UniqueCell CellUniverse::get_neighbor_cell(GeoStack& stack, Position r,
+                                           Direction u, int32_t on_surf,
+                                           uint32_t previous) const {
+  // Without a surface, there is no neighbor list to look at
+  if (on_surf == 0 || previous >= cell_indicies.size()) {
+    return this->get_cell(stack, r, u, on_surf);
+  }
 
-      if (cell->fill() == Cell::Fill::Material) {
-        ucell.cell = cell;
-        // This is a deep as it goes, so we set the ID here
-        ucell.id = ucell.cell->id();
-        ucell.instance += cell_offset_map[i].at(ucell.id);
-        return ucell;
-      }
+  stack.push_back({GeoLilyPad::PadType::Universe, id_, r, {0, 0, 0}, false});
 
-      ucell = cell->universe()->get_cell(stack, r, u, on_surf);
-      ucell.instance += cell_offset_map[i].at(ucell.id);
-      return ucell;
+  // Try the cells we have already found on the other side of this surface
+  const uint64_t key = static_cast<uint64_t>(static_cast<uint32_t>(on_surf))
+                       << 32;
+  const std::atomic<uint64_t>* slots = &neighbors[previous * NEIGHBOR_SLOTS];
+  for (std::size_t s = 0; s < NEIGHBOR_SLOTS; s++) {
+    const uint64_t entry = slots[s].load(std::memory_order_relaxed);
+    if (entry == 0) break;
+    if ((entry & 0xFFFFFFFF00000000) != key) continue;
+
+    const std::size_t i = (entry & 0xFFFFFFFF) - 1;
+    if (geometry::cells[cell_indicies[i]]->is_inside(r, u, on_surf)) {
+      return enter_cell(stack, i, r, u, on_surf);
+    }
+  }
+
+  // Fall back to searching all cells, and remember where we ended up
+  for (std::size_t i = 0; i < cell_indicies.size(); i++) {
+    const auto& indx = cell_indicies[i];
+
+    if (geometry::cells[indx]->is_inside(r, u, on_surf)) {
+      add_neighbor(previous, on_surf, i);
+      return enter_cell(stack, i, r, u, on_surf);
     }
   }
 
   // No cell found, particle is lost
+  return UniqueCell();
+}
+
+UniqueCell CellUniverse::enter_cell(GeoStack& stack, std::size_t i, Position r,
+                                    Direction u, int32_t on_surf) const {
+  UniqueCell ucell;
+  Cell* cell = geometry::cells[cell_indicies[i]].get();
+
+  // Save stack data for cell
+  stack.push_back({GeoLilyPad::PadType::Cell, cell->id(), r, {0, 0, 0}, false});
+  stack.back().cell_index = cell_indicies[i];
+  stack.back().cell_position = static_cast<uint32_t>(i);
+
+  if (cell->fill() == Cell::Fill::Material) {
+    ucell.cell = cell;
+    // This is a deep as it goes, so we set the ID here
+    ucell.id = ucell.cell->id();
+    ucell.instance += cell_offset_map[i].at(ucell.id);
+    return ucell;
+  }
+
+  ucell = cell->universe()->get_cell(stack, r, u, on_surf);
+  ucell.instance += cell_offset_map[i].at(ucell.id);
   return ucell;
 }
 
+void CellUniverse::add_neighbor(uint32_t previous, int32_t on_surf,
+                                std::size_t i) const {
+  const uint64_t entry =
+      (static_cast<uint64_t>(static_cast<uint32_t>(on_surf)) << 32) |
+      static_cast<uint64_t>(i + 1);
+  std::atomic<uint64_t>* slots = &neighbors[previous * NEIGHBOR_SLOTS];
+
+  for (std::size_t s = 0; s < NEIGHBOR_SLOTS; s++) {
+    uint64_t expected = 0;
+    if (slots[s].compare_exchange_strong(expected, entry,
+                                         std::memory_order_relaxed) ||
+        expected == entry) {
+      return;
+    }
+  }
+
+  // All slots are taken. The neighbor is simply not remembered, and will
+  // keep being found by the full search.
+}
+
 Boundary CellUniverse::get_boundary_condition(const Position& r,
                                               const Direction& u,
                                               int32_t on_surf) const {
@@ -289,6 +356,74 @@ void CellUniverse::make_offset_map() {
   }
 }
 
+void CellUniverse::flatten() {
+  if (flattened) return;
+  flattened = true;
+
+  std::vector<uint32_t> flat_indicies;
+  flat_indicies.reserve(cell_indicies.size());
+
+  for (const auto& indx : cell_indicies) {
+    // A cell filled with another cell universe is replaced by the cells of
+    // that universe, restricted to the region of the cell. Both are in the
+    // same frame, so no transformation is required. Cells are kept in the
+    // same order, so the instance numbering from make_offset_map is the same.
+    // Universes with boundary conditions are left alone, as their boundary
+    // conditions are only searched for while inside the universe.
+    Cell* cell = geometry::cells[indx].get();
+    CellUniverse* inner = nullptr;
+    if (cell->fill() == Cell::Fill::Universe) {
+      inner = dynamic_cast<CellUniverse*>(cell->universe());
+    }
+
+    if (inner == nullptr || inner->has_boundary_conditions()) {
+      flat_indicies.push_back(indx);
+      continue;
+    }
+
+    inner->flatten();
+    for (const auto& inner_indx : inner->cell_indicies) {
+      geometry::cells.push_back(
+          geometry::cells[inner_indx]->restricted_to(*cell));
+      flat_indicies.push_back(
+          static_cast<uint32_t>(geometry::cells.size() - 1));
+    }
+  }
+
+  cell_indicies = flat_indicies;
+  neighbors = std::make_unique<std::atomic<uint64_t>[]>(cell_indicies.size() *
+                                                        NEIGHBOR_SLOTS);
+}
+
+uint32_t CellUniverse::depth() const {
+  uint32_t max_depth = 0;
+
+  for (const auto& indx : cell_indicies) {
+    Cell* cell = geometry::cells[indx].get();
+
+    uint32_t cell_depth = 1;
+    if (cell->fill() == Cell::Fill::Universe) {
+      cell_depth += cell->universe()->depth();
+    }
+
+    max_depth = std::max(max_depth, cell_depth);
+  }
+
+  // Add the level of the universe itself
+  return max_depth + 1;
+}
+
+Universe* CellUniverse::trivial_fill() const {
+  if (cell_indicies.size() != 1) return nullptr;
+
+  Cell* cell = geometry::cells[cell_indicies.front()].get();
+  if (cell->is_infinite() == false || cell->fill() != Cell::Fill::Universe) {
+    return nullptr;
+  }
+
+  return cell->universe();
+}
+
 void make_cell_universe(const YAML::Node& uni_node) {
   // Get id
   uint32_t id;
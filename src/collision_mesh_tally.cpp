@@ -102,10 +102,7 @@ void CollisionMeshTally::score_collision(const Particle& p,
         scr *= p.wgt2();
         break;
     }
-#ifdef ABEILLE_USE_OMP
-#pragma omp atomic
-#endif
-    tally_gen(uE, ui, uj, uk) += scr;
+    add_score(uE, ui, uj, uk, scr);
   }
 }
 
@@ -267,5 +264,6 @@ std::shared_ptr<CollisionMeshTally> make_collision_mesh_tally(
 
   // Construct based on estimator type
   return std::make_shared<CollisionMeshTally>(plow, phi, nx, ny, nz, ebounds,
-                                              quantity, fname, mt);
+                                              quantity, fname, mt,
+                                              make_mesh_tally_storage(node));
 }
@@ -39,7 +39,8 @@ Cylinder::Cylinder(double x_, double y_, double z_, double u_, double v_,
       R{r_},
       alpha{0.},
       beta{0.},
-      gamma{0.} {
+      gamma{0.},
+      axis_aligned{false} {
   // Normalize direction
   const double mag = std::sqrt(u0 * u0 + v0 * v0 + w0 * w0);
 
@@ -55,6 +56,9 @@ Cylinder::Cylinder(double x_, double y_, double z_, double u_, double v_,
   alpha = 1. - u0 * u0;
   beta = 1. - v0 * v0;
   gamma = 1. - w0 * w0;
+
+  axis_aligned = (u0 == 1. || u0 == -1.) || (v0 == 1. || v0 == -1.) ||
+                 (w0 == 1. || w0 == -1.);
 }
 
 int Cylinder::sign(const Position& r, const Direction& u) const {
@@ -105,6 +109,18 @@ double Cylinder::distance(const Position& r, const Direction& u,
   }
 }
 
+double Cylinder::safety(const Position& r) const {
+  // The quadric used by this surface is only a true cylinder when the axis
+  // is aligned with x, y, or z. Otherwise, we can't provide a useful bound.
+  if (!axis_aligned) return 0.;
+
+  const double x = r.x() - x0;
+  const double y = r.y() - y0;
+  const double z = r.z() - z0;
+  const double rho2 = alpha * x * x + beta * y * y + gamma * z * z;
+  return std::abs(std::sqrt(rho2) - R);
+}
+
 Direction Cylinder::norm(const Position& r) const {
   return {alpha * (r.x() - x0), beta * (r.y() - y0), gamma * (r.z() - z0)};
 }
@@ -293,28 +293,119 @@ std::optional<std::pair<Position, std::size_t>> ExactMGCancelator::sample_point(
   return std::make_optional<std::pair<Position, std::size_t>>({r_smp, g});
 }
 
-void ExactMGCancelator::compute_averages(const Key& key, Material* mat,
-                                         MGNuclide* nuclide, CancelBin& bin) {
-  // Make sure vectors are allocated
-  bin.averages.resize(bin.particles.size());
+void ExactMGCancelator::build_sample_set(const Key& key, Material* mat,
+                                         SampleSet& samples) const {
+  samples.built = true;
+  samples.valid = false;
+  samples.x.reserve(N_SAMPLES);
+  samples.y.reserve(N_SAMPLES);
+  samples.z.reserve(N_SAMPLES);
+  samples.g.reserve(N_SAMPLES);
 
-  // Get all position and energies
-  std::vector<std::pair<Position, std::size_t>> r_E_smps;
-  r_E_smps.reserve(N_SAMPLES);
   unsigned long long sobol_index = 0;
   for (std::size_t j = 0; j < N_SAMPLES; j++) {
     std::optional<std::pair<Position, std::size_t>> r_E_smp =
         sample_point(key, mat, sobol_index);
     if (r_E_smp) {
-      r_E_smps.push_back(r_E_smp.value());
+      samples.x.push_back(r_E_smp->first.x());
+      samples.y.push_back(r_E_smp->first.y());
+      samples.z.push_back(r_E_smp->first.z());
+      samples.g.push_back(r_E_smp->second);
     } else {
-      // We couldn't sample a point, so we just wont cancel
-      // this bin.
-      bin.can_cancel = false;
+      // We couldn't sample a point, so this bin will never be cancelled.
+      samples = SampleSet();
+      samples.built = true;
       return;
     }
   }
 
+  samples.valid = true;
+}
+
+bool ExactMGCancelator::average_f(const SampleSet& samples,
+                                  const Position& r1, const Direction& u1,
+                                  std::size_t g1, std::size_t g3, double Esmp,
+                                  MGNuclide* nuclide,
+                                  CancelBin::Averages& averages) const {
+  // Scratch arrays, which are reused by all particles on a thread
+  thread_local std::vector<double> mu;
+  thread_local std::vector<double> pdf;
+  thread_local std::vector<double> kernel;
+
+  const std::size_t N = samples.size();
+  mu.resize(N);
+  pdf.resize(N);
+  kernel.resize(N);
+
+  const double* x = samples.x.data();
+  const double* y = samples.y.data();
+  const double* z = samples.z.data();
+  double* mu_ptr = mu.data();
+  double* kernel_ptr = kernel.data();
+  const double x1 = r1.x(), y1 = r1.y(), z1 = r1.z();
+  const double u = u1.x(), v = u1.y(), w = u1.z();
+
+  // Geometric part of f, and the scattering cosine, for all points. There
+  // are no lookups in this loop, so that it can be vectorized.
+#ifdef ABEILLE_USE_OMP
+#pragma omp simd
+#endif
+  for (std::size_t j = 0; j < N; j++) {
+    const double dx = x[j] - x1;
+    const double dy = y[j] - y1;
+    const double dz = z[j] - z1;
+    const double d2 = dx * dx + dy * dy + dz * dz;
+    const double d = std::sqrt(d2);
+    mu_ptr[j] = (dx * u + dy * v + dz * w) / d;
+    kernel_ptr[j] = std::exp(-Esmp * d) / d2;
+  }
+
+  // Scattering pdf for all points
+  nuclide->angles()[g1][g3].pdf(mu.data(), pdf.data(), N);
+
+  // The pdf for the chi portion
+  double* pdf_ptr = pdf.data();
+  if (CHI_MATRIX) {
+    const double* chi = nuclide->chi()[g3].data();
+    const std::size_t* g4 = samples.g.data();
+    for (std::size_t j = 0; j < N; j++) pdf_ptr[j] *= chi[g4[j]];
+  }
+
+  double sum_f = 0.;
+  double sum_f_inv = 0.;
+  bool has_zero = false;
+#ifdef ABEILLE_USE_OMP
+#pragma omp simd reduction(+ : sum_f, sum_f_inv) reduction(|| : has_zero)
+#endif
+  for (std::size_t j = 0; j < N; j++) {
+    const double f = pdf_ptr[j] * kernel_ptr[j];
+    has_zero = has_zero || (f == 0.);
+    sum_f += f;
+    sum_f_inv += 1. / f;
+  }
+
+  if (has_zero) return false;
+
+  averages.f = sum_f / static_cast<double>(N);
+  averages.f_inv = sum_f_inv / static_cast<double>(N);
+  return true;
+}
+
+void ExactMGCancelator::compute_averages(const Key& key, Material* mat,
+                                         MGNuclide* nuclide, CancelBin& bin,
+                                         SampleSet& samples) {
+  // Make sure vectors are allocated
+  bin.averages.resize(bin.particles.size());
+
+  // Get all position and energies. These are only sampled once per bin.
+  if (!samples.built) build_sample_set(key, mat, samples);
+  if (!samples.valid) {
+    // We couldn't sample a point, so we just wont cancel
+    // this bin.
+    bin.can_cancel = false;
+    return;
+  }
+
   // Go through all particles
   for (std::size_t i = 0; i < bin.particles.size(); i++) {
     const Position& r1 = bin.particles[i]->parents_previous_position;
@@ -326,21 +417,11 @@ void ExactMGCancelator::compute_averages(const Key& key, Material* mat,
     const double Esmp = bin.particles[i]->Esmp_parent;
 
     // Compute the average value for f and 1/f
-    double sum_f = 0.;
-    double sum_f_inv = 0.;
-    for (const auto& r_E_smp : r_E_smps) {
-      const Position& r4 = r_E_smp.first;
-      const std::size_t g4 = r_E_smp.second;
-      double f = get_f(r1, u1, g1, g3, r4, g4, Esmp, nuclide);
-      if (f == 0.) {
-        bin.can_cancel = false;
-        return;
-      }
-      sum_f += f;
-      sum_f_inv += 1. / f;
+    if (!average_f(samples, r1, u1, g1, g3, Esmp, nuclide,
+                   bin.averages[i])) {
+      bin.can_cancel = false;
+      return;
     }
-    bin.averages[i].f = sum_f / static_cast<double>(N_SAMPLES);
-    bin.averages[i].f_inv = sum_f_inv / static_cast<double>(N_SAMPLES);
   }
 
   auto C = [](double f, double f_inv) { return 1. / (2. * f * f_inv - 1.); };
@@ -415,6 +496,12 @@ void ExactMGCancelator::perform_cancellation(pcg32&) {
       key_mat_pairs.emplace_back(key, mat_bin_pair.first);
   }
 
+  // Make sure every bin has an entry for its sample points, so that the
+  // sample_sets map isn't modified inside the parallel loop. The points
+  // themselves are sampled lazily, as most bins never need them.
+  for (const auto& key_mat : key_mat_pairs)
+    sample_sets[key_mat.first].try_emplace(key_mat.second);
+
   // Go through all bins
 #ifdef ABEILLE_USE_OMP
 #pragma omp parallel for
@@ -423,6 +510,7 @@ void ExactMGCancelator::perform_cancellation(pcg32&) {
     Key key = key_mat_pairs[i].first;
     Material* mat = key_mat_pairs[i].second;
     CancelBin& bin = bins[key][mat];
+    SampleSet& samples = sample_sets[key][mat];
 
     // For cancellation to be eact in the most general MG case,
     // need access to all scattering PDFs, and to the Chi matrix,
@@ -458,7 +546,7 @@ void ExactMGCancelator::perform_cancellation(pcg32&) {
       // average value of the fission density and 1 / fission density for each
       // particle in the bin.
       if ((has_pos_w1 && has_neg_w1) || (has_pos_w2 && has_neg_w2)) {
-        compute_averages(key, mat, nuclide, bin);
+        compute_averages(key, mat, nuclide, bin, samples);
       }
 
       // If determined necessary, carry out the cancellations for each weight
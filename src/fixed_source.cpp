@@ -48,21 +48,9 @@ void FixedSource::print_header() {
 }
 
 void FixedSource::mpi_setup() {
-  // Calculate the base number of particles per node to run
-  uint64_t base_particles_per_node =
-      static_cast<uint64_t>(settings::nparticles / mpi::size);
-  uint64_t remainder = static_cast<uint64_t>(settings::nparticles % mpi::size);
-
-  // Set the base number of particles per node in the node_nparticles vector
-  mpi::node_nparticles.resize(static_cast<std::size_t>(mpi::size),
-                              base_particles_per_node);
-
-  // Distribute the remainder particles amongst the nodes. There are at most
-  // mpi::size-1 remainder particles, so we will distribute them untill we
-  // have no more.
-  for (std::size_t rank = 0; rank < remainder; rank++) {
-    mpi::node_nparticles[rank]++;
-  }
+  // Calculate the number of particles per node to run
+  mpi::node_nparticles =
+      mpi::split(static_cast<uint64_t>(settings::nparticles));
 
   // Now we need to make sure that the history_counter for each node is at
   // the right starting location.
@@ -73,9 +61,17 @@ void FixedSource::mpi_setup() {
 }
 
 void FixedSource::mpi_advance() {
-  histories_counter +=
-      static_cast<uint64_t>(settings::nparticles) -
-      mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)];
+  global_histories_counter += static_cast<uint64_t>(settings::nparticles);
+
+  // The number of particles each node should run may have changed
+  mpi::node_nparticles =
+      mpi::split(static_cast<uint64_t>(settings::nparticles));
+
+  histories_counter = global_histories_counter;
+  for (int lower_rank = 0; lower_rank < mpi::rank; lower_rank++) {
+    histories_counter +=
+        mpi::node_nparticles[static_cast<std::size_t>(lower_rank)];
+  }
 }
 
 void FixedSource::run() {
@@ -99,23 +95,29 @@ void FixedSource::run() {
   mpi::synchronize();
   simulation_timer.start();
 
-  // Get the number of particles that this node should run
-  uint64_t node_nparticles =
-      mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)];
-
   for (int g = 1; g <= settings::ngenerations; g++) {
     gen = g;
 
+    // Get the number of particles that this node should run
+    uint64_t node_nparticles =
+        mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)];
+
     // First, sample the sources and place into bank
     bank = this->sample_sources(node_nparticles);
 
     // Now transport all particles. In fixed-source mode, this should
-    // return and empty vector !
+    // return and empty vector ! The bank is cleared by the transport, so the
+    // number of particles is kept for the rank weights.
+    const uint64_t nprt = bank.size();
+    transport_timer.reset();
+    transport_timer.start();
     auto fission_bank = transporter->transport(bank);
+    transport_timer.stop();
     if (!fission_bank.empty()) {
       fatal_error("Returned bank not empty on fixed-source transport.");
     }
     transported_histories += bank.size();
+    update_rank_weights(nprt);
     mpi::synchronize();
 
     // Get new values
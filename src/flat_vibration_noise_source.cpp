@@ -42,6 +42,7 @@ FlatVibrationNoiseSource::FlatVibrationNoiseSource(
       x0_(),
       w0_(angular_frequency),
       eps_(),
+      harmonics_(),
       Delta_N() {
   // Check low and high
   if (low_.x() >= hi_.x() || low_.y() >= hi_.y() || low_.z() >= hi_.z()) {
@@ -128,25 +129,21 @@ double FlatVibrationNoiseSource::get_nuclide_concentration(
   return 0.;
 }
 
-double FlatVibrationNoiseSource::Et(double x, double E) const {
-  if (x < x0_) {
-    MaterialHelper mat_neg(material_neg_.get(), E);
-    return mat_neg.Et(E);
-  } else {
-    MaterialHelper mat_pos(material_pos_.get(), E);
-    return mat_pos.Et(E);
-  }
+double FlatVibrationNoiseSource::Et(Material* material, MaterialHelper& mat,
+                                    double E) const {
+  // The helper is temporarily pointed to the other material, so that the
+  // micro xs already computed for the particle at E, and its URR random
+  // values, are reused.
+  Material* current = mat.material();
+  mat.set_material(material, E);
+  const double xs = mat.Et(E);
+  mat.set_material(current, E);
+  return xs;
 }
 
-double FlatVibrationNoiseSource::Delta_Et(double E) const {
-  // Make material helpers and evaluate XS
-  MaterialHelper mat_neg(material_neg_.get(), E);
-  double xs_neg = mat_neg.Et(E);
-
-  MaterialHelper mat_pos(material_pos_.get(), E);
-  double xs_pos = mat_pos.Et(E);
-
-  return xs_neg - xs_pos;
+double FlatVibrationNoiseSource::Delta_Et(MaterialHelper& mat,
+                                          double E) const {
+  return Et(material_neg_.get(), mat, E) - Et(material_pos_.get(), mat, E);
 }
 
 std::complex<double> FlatVibrationNoiseSource::C_R(uint32_t n, double x) const {
@@ -188,6 +185,11 @@ std::complex<double> FlatVibrationNoiseSource::C_L(uint32_t n, double x) const {
   return CL;
 }
 
+std::complex<double> FlatVibrationNoiseSource::C(const Harmonic& h,
+                                                 double x) const {
+  return (negative_material(x) ? C_L(h.n, x) : C_R(h.n, x)) * h.phase;
+}
+
 bool FlatVibrationNoiseSource::negative_material(double x) const {
   return x < x0_ ? true : false;
 }
@@ -218,94 +220,68 @@ double FlatVibrationNoiseSource::get_x(const Position& r) const {
   return 0.;
 }
 
-std::complex<double> FlatVibrationNoiseSource::dEt(const Position& r, double E,
-                                                   double w) const {
-  const double x = get_x(r);
-  const bool use_neg = negative_material(x);
-  const double D_Et = Delta_Et(E);
-
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
+void FlatVibrationNoiseSource::set_frequencies(const std::vector<double>& w) {
+  harmonics_.clear();
+  harmonics_.reserve(w.size());
 
-  double err = ((n * w0_) - w) / w;
-  if (std::abs(err) > 0.01) {
-    // We don't have an actual multiple of the frequency. No noise component.
-    return {0., 0.};
-  }
+  for (const double& wf : w) {
+    // Get the frequency multiple n
+    int32_t n = static_cast<int32_t>(std::round(wf / w0_));
 
-  uint32_t un = static_cast<uint32_t>(std::abs(n));
+    // We only have a noise component for actual multiples of the frequency
+    double err = ((n * w0_) - wf) / wf;
 
-  std::complex<double> C = use_neg ? C_L(un, x) : C_R(un, x);
+    Harmonic h;
+    h.active = std::abs(err) <= 0.01;
+    h.n = static_cast<uint32_t>(std::abs(n));
+    h.phase = {1., 0.};
+    if (n < 0) {
+      h.phase = std::exp(i * static_cast<double>(h.n) * PI);
+    }
 
-  if (n < 0) {
-    return D_Et * C * std::exp(i * static_cast<double>(un) * PI);
+    harmonics_.push_back(h);
   }
+}
+
+std::complex<double> FlatVibrationNoiseSource::dEt(const Position& r,
+                                                   MaterialHelper& mat,
+                                                   double E,
+                                                   std::size_t freq) const {
+  const Harmonic& h = harmonics_[freq];
+  if (h.active == false) return {0., 0.};
 
-  return D_Et * C;
+  const double x = get_x(r);
+  return Delta_Et(mat, E) * C(h, x);
 }
 
 std::complex<double> FlatVibrationNoiseSource::dEt_Et(const Position& r,
+                                                      MaterialHelper& mat,
                                                       double E,
-                                                      double w) const {
+                                                      std::size_t freq) const {
+  const Harmonic& h = harmonics_[freq];
+  if (h.active == false) return {0., 0.};
+
   const double x = get_x(r);
-  const bool use_neg = negative_material(x);
-  const double D_Et = Delta_Et(E);
-  const double xs = Et(x, E);
+  const double xs = negative_material(x) ? Et(material_neg_.get(), mat, E)
+                                         : Et(material_pos_.get(), mat, E);
   if (xs == 0.) return {0., 0.};
 
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
-
-  double err = ((n * w0_) - w) / w;
-  if (std::abs(err) > 0.01) {
-    // We don't have an actual multiple of the frequency. No noise component.
-    return {0., 0.};
-  }
-
-  uint32_t un = static_cast<uint32_t>(std::abs(n));
-
-  std::complex<double> C = use_neg ? C_L(un, x) : C_R(un, x);
-
-  if (n < 0) {
-    return D_Et * C * std::exp(i * static_cast<double>(un) * PI) / xs;
-  }
-
-  return D_Et * C / xs;
+  return Delta_Et(mat, E) * C(h, x) / xs;
 }
 
 std::complex<double> FlatVibrationNoiseSource::dN(const Position& r,
                                                   uint32_t nuclide_id,
-                                                  double w) const {
-  const double x = get_x(r);
-  const bool use_neg = negative_material(x);
-  double D_N = 0.;
-
-  // Look-up nuclide_id to get pre-computed delta
-  if (Delta_N.find(nuclide_id) != Delta_N.end()) {
-    D_N = Delta_N.at(nuclide_id);
-  } else {
-    // D_N here would be zero, so we just return.
-    return {0., 0.};
-  }
-
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
-
-  double err = ((n * w0_) - w) / w;
-  if (std::abs(err) > 0.01) {
-    // We don't have an actual multiple of the frequency. No noise component.
-    return {0., 0.};
-  }
+                                                  std::size_t freq) const {
+  const Harmonic& h = harmonics_[freq];
+  if (h.active == false) return {0., 0.};
 
-  uint32_t un = static_cast<uint32_t>(std::abs(n));
+  // Look-up nuclide_id to get pre-computed delta. If it isn't there, D_N
+  // would be zero, so we just return.
+  auto it = Delta_N.find(nuclide_id);
+  if (it == Delta_N.end()) return {0., 0.};
 
-  std::complex<double> C = use_neg ? C_L(un, x) : C_R(un, x);
-
-  if (n < 0) {
-    return D_N * C * std::exp(i * static_cast<double>(un) * PI);
-  }
-
-  return D_N * C;
+  const double x = get_x(r);
+  return it->second * C(h, x);
 }
 
 std::shared_ptr<VibrationNoiseSource> make_flat_vibration_noise_source(
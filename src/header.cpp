@@ -68,9 +68,9 @@ const std::string info =
 const std::string help =
     " Usage:\n"
 #ifdef ABEILLE_USE_OMP
-    "   abeille (--input FILE) [--threads NUM --output FILE]\n"
+    "   abeille (--input FILE) [--threads NUM --output FILE --restart FILE]\n"
 #else
-    "   abeille (--input FILE) [--output FILE]\n"
+    "   abeille (--input FILE) [--output FILE --restart FILE]\n"
 #endif
     "   abeille (--input FILE) (--gui-plot | --plot) [--threads NUM]\n"
     "   abeille (-h | --help)\n"
@@ -84,6 +84,7 @@ const std::string help =
     "   -t --threads NUM  Set number of OpenMP threads\n"
 #endif
     "   -o --output FILE  Set output file\n"
+    "   -r --restart FILE Restart from a checkpoint file\n"
 #ifdef ABEILLE_GUI_PLOT
     "   -g --gui-plot     Interactive GUI plotter\n"
 #endif
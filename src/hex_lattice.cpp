@@ -25,6 +25,7 @@
 #include <geometry/hex_lattice.hpp>
 #include <utils/error.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 HexLattice::HexLattice(uint32_t nrings, uint32_t nz, double p, double pz,
@@ -53,27 +54,29 @@ HexLattice::HexLattice(uint32_t nrings, uint32_t nz, double p, double pz,
   width = 2 * (Nrings - 1) + 1;
 
   mid_qr = width / 2;
-}
 
-bool HexLattice::is_inside(Position r, Direction /*u*/) const {
-  // Get coordinates in frame of center tile
-  Position r_o{r.x() - X_o, r.y() - Y_o, r.z() - Z_o};
+  // Steps to the neighboring tiles along which the faces are found
+  if (top_ == Top::Flat) {
+    face_step = {{{0, 1}, {1, 0}, {1, -1}}};
+  } else {
+    face_step = {{{1, 0}, {0, 1}, {-1, 1}}};
+  }
 
-  // Get qr of hearest hex tile
-  std::array<int32_t, 2> qr = get_nearest_hex(r_o);
+  for (std::size_t k = 0; k < 3; k++) {
+    Position n = get_hex_center(face_step[k]);
+    face_nx[k] = n.x() / pitch_;
+    face_ny[k] = n.y() / pitch_;
+  }
+}
 
-  // Get the ring of hex tile
-  uint32_t ring = get_ring(qr);
+bool HexLattice::is_inside(Position r, Direction u) const {
+  std::array<int32_t, 3> qrz = get_tile(r, u);
 
   // See if valid ring or not
-  if (ring >= Nrings)
-    // Invalid ring
-    return false;
+  if (get_ring({qrz[0], qrz[1]}) >= Nrings) return false;
 
   // Check z bin now
-  double Z_low = Z_o - 0.5 * static_cast<double>(Nz) * pitch_z_;
-  int32_t nz = static_cast<int32_t>(std::floor((r.z() - Z_low) / pitch_z_));
-  if (nz < 0 || nz >= static_cast<int32_t>(Nz)) return false;
+  if (qrz[2] < 0 || qrz[2] >= static_cast<int32_t>(Nz)) return false;
 
   return true;
 }
@@ -82,138 +85,72 @@ UniqueCell HexLattice::get_cell(Position r, Direction u,
                                 int32_t on_surf) const {
   UniqueCell ucell;
 
-  // Get coordinates in frame of center tile
-  Position r_o{r.x() - X_o, r.y() - Y_o, r.z() - Z_o};
-
-  // Get qr of hearest hex tile
-  std::array<int32_t, 3> qrz = get_tile(r_o, u);
-
-  // Get the ring of hex tile
-  uint32_t ring = get_ring({qrz[0], qrz[1]});
-
-  // See if valid ring or not
-  if (ring >= Nrings) {
-    // Invalid ring
-    if (outer_universe_index == -1) {
-      return ucell;
-    } else {
-      ucell = geometry::universes[static_cast<uint32_t>(outer_universe_index)]
-                  ->get_cell(r, u, on_surf);
-      if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
-      return ucell;
-    }
-  }
-
-  // Check z bin now
-  if (qrz[2] < 0 || qrz[2] >= static_cast<int32_t>(Nz)) {
-    if (outer_universe_index == -1) {
-      return ucell;
-    } else {
-      ucell = geometry::universes[static_cast<uint32_t>(outer_universe_index)]
-                  ->get_cell(r, u, on_surf);
-      if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
-      return ucell;
-    }
-  }
+  std::array<int32_t, 3> qrz = get_tile(r, u);
+  std::size_t indx = 0;
+  const int32_t univ_indx = tile_universe(qrz, indx);
 
-  // Inside a lattice bin
-  const size_t indx = linear_index({qrz[0], qrz[1]}, qrz[2]);
+  if (univ_indx < 0) {
+    // Outside of the lattice or in a dummy element, try outer_universe
+    if (outer_universe_index < 0) return ucell;
 
-  // If -1, send to outside universe
-  if (lattice_universes[indx] == -1) {
-    if (outer_universe_index == -1) {
-      return ucell;
-    } else {
-      ucell = geometry::universes[static_cast<uint32_t>(outer_universe_index)]
-                  ->get_cell(r, u, on_surf);
-      if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
-      return ucell;
-    }
+    ucell = geometry::universes[static_cast<std::size_t>(outer_universe_index)]
+                ->get_cell(r, u, on_surf);
+    if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
+    return ucell;
   }
 
   // Move coordinates to tile center
-  Position center = tile_center(qrz[0], qrz[1], qrz[2]);
-  Position r_tile = r_o - center;
-  ucell = geometry::universes[static_cast<uint32_t>(lattice_universes[indx])]
-              ->get_cell(r_tile, u, on_surf);
+  Position r_tile = r - tile_center(qrz[0], qrz[1], qrz[2]);
+  ucell = geometry::universes[static_cast<std::size_t>(univ_indx)]->get_cell(
+      r_tile, u, on_surf);
   if (ucell) ucell.instance += cell_offset_map[indx].at(ucell.id);
   return ucell;
 }
 
-UniqueCell HexLattice::get_cell(std::vector<GeoLilyPad>& stack, Position r,
-                                Direction u, int32_t on_surf) const {
+UniqueCell HexLattice::get_cell(GeoStack& stack, Position r, Direction u,
+                                int32_t on_surf) const {
   UniqueCell ucell;
 
-  // Get coordinates in frame of center tile
-  Position r_o{r.x() - X_o, r.y() - Y_o, r.z() - Z_o};
+  std::array<int32_t, 3> qrz = get_tile(r, u);
+  std::size_t indx = 0;
+  const int32_t univ_indx = tile_universe(qrz, indx);
 
-  // Get qr of hearest hex tile
-  std::array<int32_t, 3> qrz = get_tile(r_o, u);
+  // The center of the tile is cached in the stack, for the Tracker
+  const Position center = tile_center(qrz[0], qrz[1], qrz[2]);
 
-  // Get the ring of hex tile
-  uint32_t ring = get_ring({qrz[0], qrz[1]});
+  if (univ_indx < 0) {
+    // Outside of the lattice or in a dummy element, try outer_universe
+    const bool has_outer = outer_universe_index >= 0;
+    stack.push_back(
+        {GeoLilyPad::PadType::Lattice, id_, r, qrz, has_outer, center});
+    if (has_outer == false) return ucell;
 
-  // See if valid ring or not
-  if (ring >= Nrings) {
-    // Invalid ring
-    if (outer_universe_index == -1) {
-      // Save info to stack
-      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, false});
-      return ucell;
-    } else {
-      // Save info to stack
-      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, true});
-      ucell = geometry::universes[static_cast<uint32_t>(outer_universe_index)]
-                  ->get_cell(stack, r, u, on_surf);
-      if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
-      return ucell;
-    }
+    ucell = geometry::universes[static_cast<std::size_t>(outer_universe_index)]
+                ->get_cell(stack, r, u, on_surf);
+    if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
+    return ucell;
   }
 
-  // Check z bin now
-  if (qrz[2] < 0 || qrz[2] >= static_cast<int32_t>(Nz)) {
-    if (outer_universe_index == -1) {
-      // Save info to stack
-      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, false});
-      return ucell;
-    } else {
-      // Save info to stack
-      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, true});
-      ucell = geometry::universes[static_cast<uint32_t>(outer_universe_index)]
-                  ->get_cell(stack, r, u, on_surf);
-      if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
-      return ucell;
-    }
-  }
-
-  // Inside a lattice bin
-  const size_t indx = linear_index({qrz[0], qrz[1]}, qrz[2]);
+  // Save info to stack, and move coordinates to tile center
+  stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, false, center});
+  ucell = geometry::universes[static_cast<std::size_t>(univ_indx)]->get_cell(
+      stack, r - center, u, on_surf);
+  if (ucell) ucell.instance += cell_offset_map[indx].at(ucell.id);
+  return ucell;
+}
 
-  // If -1, send to outside universe
-  if (lattice_universes[indx] == -1) {
-    if (outer_universe_index == -1) {
-      // Save info to stack
-      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, false});
-      return ucell;
-    } else {
-      // Save info to stack
-      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, true});
-      ucell = geometry::universes[static_cast<uint32_t>(outer_universe_index)]
-                  ->get_cell(stack, r, u, on_surf);
-      if (ucell) ucell.instance += cell_offset_map.back().at(ucell.id);
-      return ucell;
-    }
+int32_t HexLattice::tile_universe(std::array<int32_t, 3> qrz,
+                                  std::size_t& indx) const {
+  // Outside of the rings, or outside of the axial bins
+  if (get_ring({qrz[0], qrz[1]}) >= Nrings ||
+      (qrz[2] < 0 || qrz[2] >= static_cast<int32_t>(Nz))) {
+    return -1;
   }
 
-  // Move coordinates to tile center
-  Position center = tile_center(qrz[0], qrz[1], qrz[2]);
-  Position r_tile = r_o - center;
-  // Save info to stack
-  stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, qrz, false});
-  ucell = geometry::universes[static_cast<uint32_t>(lattice_universes[indx])]
-              ->get_cell(stack, r_tile, u, on_surf);
-  if (ucell) ucell.instance += cell_offset_map[indx].at(ucell.id);
-  return ucell;
+  indx = linear_index({qrz[0], qrz[1]}, qrz[2]);
+
+  // Dummy elements are negative
+  return std::max(lattice_universes[indx], -1);
 }
 
 void HexLattice::set_elements(std::vector<int32_t> univs) {
@@ -300,10 +237,35 @@ std::array<int32_t, 2> HexLattice::get_nearest_hex(Position p) const {
   return {static_cast<int32_t>(rx), static_cast<int32_t>(rz)};
 }
 
-std::array<int32_t, 3> HexLattice::get_tile(Position p, Direction /*u*/) const {
-  std::array<int32_t, 2> qr = get_nearest_hex(p);
+std::array<int32_t, 3> HexLattice::get_tile(Position p, Direction u) const {
+  std::array<int32_t, 2> qr = get_nearest_hex({p.x() - X_o, p.y() - Y_o, 0.});
   double Z_low = Z_o - 0.5 * static_cast<double>(Nz) * pitch_z_;
   int32_t nz = static_cast<int32_t>(std::floor((p.z() - Z_low) / pitch_z_));
+
+  // If we are on one of the faces of the tile, use the direction to see if
+  // we are going in or out of the tile.
+  const Position r_tile = p - tile_center(qr[0], qr[1], nz);
+  for (std::size_t k = 0; k < 3; k++) {
+    const double s = face_nx[k] * r_tile.x() + face_ny[k] * r_tile.y();
+    const double v = face_nx[k] * u.x() + face_ny[k] * u.y();
+
+    if (std::abs(0.5 * pitch_ - s) < SURFACE_COINCIDENT && v >= 0.) {
+      qr[0] += face_step[k][0];
+      qr[1] += face_step[k][1];
+    } else if (std::abs(0.5 * pitch_ + s) < SURFACE_COINCIDENT && v < 0.) {
+      qr[0] -= face_step[k][0];
+      qr[1] -= face_step[k][1];
+    }
+  }
+
+  if (std::abs(0.5 * pitch_z_ - r_tile.z()) < SURFACE_COINCIDENT &&
+      u.z() >= 0.) {
+    nz++;
+  } else if (std::abs(0.5 * pitch_z_ + r_tile.z()) < SURFACE_COINCIDENT &&
+             u.z() < 0.) {
+    nz--;
+  }
+
   return {qr[0], qr[1], nz};
 }
 
@@ -327,7 +289,7 @@ Position HexLattice::tile_center(int q, int r, int nz) const {
   double Z_low = Z_o - 0.5 * static_cast<double>(Nz) * pitch_z_;
   Position r_hex = get_hex_center({q, r});
   double z = (static_cast<double>(nz) + 0.5) * pitch_z_ + Z_low;
-  return Position(r_hex.x(), r_hex.y(), z);
+  return Position(r_hex.x() + X_o, r_hex.y() + Y_o, z);
 }
 
 uint32_t HexLattice::get_ring(std::array<int32_t, 2> qr) const {
@@ -347,108 +309,44 @@ uint32_t HexLattice::get_ring(std::array<int32_t, 2> qr) const {
 double HexLattice::distance_to_tile_boundary(
     Position r_local, Direction u, std::array<int32_t, 3> tile) const {
   Position center = tile_center(tile[0], tile[1], tile[2]);
-  Position r_tile = r_local - center;
-
-  if (top_ == Top::Pointy)
-    return distance_to_tile_boundary_pointy(r_tile, u);
-  else
-    return distance_to_tile_boundary_flat(r_tile, u);
+  return distance_in_tile(r_local - center, u);
 }
 
-double HexLattice::distance_to_tile_boundary_pointy(Position r_tile,
-                                                    Direction u) const {
-  // Points needed to calculate slopes for lines. Only need two sets
-  // because of symmetry reasons.
-  //    (x1,y1)
-  /*      /\
-         |  |(x2,y2)  */
-  double x1 = 0.;
-  double y1 = pitch_ / (2. * cos_pi_6);
-  double x2 = pitch_ / 2.;
-  double y2 = pitch_ / (2. * sin_pi_6);
-
-  double d = INF;
-
-  // Get distance to all six hexagon surfaces
-  double d1 = distance_to_line(r_tile, u, x1, y1, x2, y1);
-  double d2 = distance_to_line(r_tile, u, x2, y2, x2, -y2);
-  double d3 = distance_to_line(r_tile, u, x2, -y2, x1, -y1);
-  double d4 = distance_to_line(r_tile, u, x1, -y1, -x2, -y2);
-  double d5 = distance_to_line(r_tile, u, -x2, -y2, -x2, y2);
-  double d6 = distance_to_line(r_tile, u, -x2, y2, x1, y1);
-
-  // Get distance to z planes
-  double dzl = (-pitch_z_ * 0.5 - r_tile.z()) / u.z();
-  double dzu = (pitch_z_ * 0.5 - r_tile.z()) / u.z();
-
-  if (d1 > 0. && d1 < d) d = d1;
-  if (d2 > 0. && d2 < d) d = d2;
-  if (d3 > 0. && d3 < d) d = d3;
-  if (d4 > 0. && d4 < d) d = d4;
-  if (d5 > 0. && d5 < d) d = d5;
-  if (d6 > 0. && d6 < d) d = d6;
-  if (dzl > 0. && dzl < d) d = dzl;
-  if (dzu > 0. && dzu < d) d = dzu;
-
-  return d;
-}
+double HexLattice::distance_in_tile(Position r_tile, Direction u) const {
+  // Position and direction along the normals of the three pairs of hexagon
+  // faces, and of the pair of axial planes.
+  const std::array<double, 4> s{
+      face_nx[0] * r_tile.x() + face_ny[0] * r_tile.y(),
+      face_nx[1] * r_tile.x() + face_ny[1] * r_tile.y(),
+      face_nx[2] * r_tile.x() + face_ny[2] * r_tile.y(), r_tile.z()};
+  const std::array<double, 4> v{face_nx[0] * u.x() + face_ny[0] * u.y(),
+                                face_nx[1] * u.x() + face_ny[1] * u.y(),
+                                face_nx[2] * u.x() + face_ny[2] * u.y(),
+                                u.z()};
+  const std::array<double, 4> h{0.5 * pitch_, 0.5 * pitch_, 0.5 * pitch_,
+                                0.5 * pitch_z_};
+
+  double dist = INF;
+  for (std::size_t k = 0; k < 4; k++) {
+    // Only the face we are heading towards can be hit. If v is zero, d is
+    // infinite (or NaN), and is rejected.
+    const double diff = std::copysign(h[k], v[k]) - s[k];
+    const double d = diff / v[k];
+    if (d > 0. && d < dist && std::abs(diff) > 100 * SURFACE_COINCIDENT)
+      dist = d;
+  }
 
-double HexLattice::distance_to_tile_boundary_flat(Position r_tile,
-                                                  Direction u) const {
-  // Points needed to calculate slopes for lines. Only need two sets
-  // because of symmetry reasons.
-  //
-  /*        --- (x1, y1)
-           /   \
-                 (x2, y2)  */
-  double x1 = pitch_ / (2. * sin_pi_6);
-  double y1 = pitch_ / 2.;
-  double x2 = pitch_ / (2. * cos_pi_6);
-  double y2 = 0.;
-
-  double d = INF;
-
-  // Get distance to all six hexagon surfaces
-  double d1 = distance_to_line(r_tile, u, x1, y1, x2, y1);
-  double d2 = distance_to_line(r_tile, u, x2, y2, x1, -y1);
-  double d3 = distance_to_line(r_tile, u, x1, -y1, -x1, -y1);
-  double d4 = distance_to_line(r_tile, u, -x1, -y1, -x2, -y2);
-  double d5 = distance_to_line(r_tile, u, -x2, -y2, -x1, y1);
-  double d6 = distance_to_line(r_tile, u, -x1, y1, x1, y1);
-
-  // Get distance to z planes
-  double dzl = (-pitch_z_ * 0.5 - r_tile.z()) / u.z();
-  double dzu = (pitch_z_ * 0.5 - r_tile.z()) / u.z();
-
-  if (d1 > 0. && d1 < d) d = d1;
-  if (d2 > 0. && d2 < d) d = d2;
-  if (d3 > 0. && d3 < d) d = d3;
-  if (d4 > 0. && d4 < d) d = d4;
-  if (d5 > 0. && d5 < d) d = d5;
-  if (d6 > 0. && d6 < d) d = d6;
-  if (dzl > 0. && dzl < d) d = dzl;
-  if (dzu > 0. && dzu < d) d = dzu;
-
-  return d;
+  return dist;
 }
 
-double HexLattice::distance_to_line(Position r, Direction u, double x1,
-                                    double y1, double x2, double y2) const {
-  // Get A, B, and D for plane from y - y1 = m (x - x1) ; m = (y2 - y1)/(x2 -
-  // x1)
-  double A = y2 - y1;
-  double B = x1 - x2;
-  double D = (x2 - x1) * y1 - (y2 - y1) * x1;
-
-  double num = D - A * r.x() - B * r.y();
-  double denom = A * u.x() + B * u.y();
-
-  double d = num / denom;
+double HexLattice::safety_in_tile(Position r_tile) const {
+  double safety = 0.5 * pitch_z_ - std::abs(r_tile.z());
+  for (std::size_t k = 0; k < 3; k++) {
+    const double s = face_nx[k] * r_tile.x() + face_ny[k] * r_tile.y();
+    safety = std::min(safety, 0.5 * pitch_ - std::abs(s));
+  }
 
-  if (d < 0.)
-    return INFINITY;
-  else
-    return d;
+  return std::max(safety, 0.);
 }
 
 void make_hex_lattice(const YAML::Node& latt_node, const YAML::Node& input) {
@@ -73,6 +73,15 @@ ImplicitLeakageDeltaTracker::ImplicitLeakageDeltaTracker(
 std::vector<BankedParticle> ImplicitLeakageDeltaTracker::transport(
     std::vector<Particle>& bank, bool noise,
     std::vector<BankedParticle>* noise_bank, const NoiseMaker* noise_maker) {
+  return dispatch_transport(noise, [&](auto mode) {
+    return transport_particles<decltype(mode)>(bank, noise_bank, noise_maker);
+  });
+}
+
+template <typename Mode>
+std::vector<BankedParticle> ImplicitLeakageDeltaTracker::transport_particles(
+    std::vector<Particle>& bank, std::vector<BankedParticle>* noise_bank,
+    const NoiseMaker* noise_maker) {
 #ifdef ABEILLE_USE_OMP
 #pragma omp parallel
 #endif
@@ -100,14 +109,14 @@ std::vector<BankedParticle> ImplicitLeakageDeltaTracker::transport(
       // Only make helper if we aren't lost, to make sure that material isn't
       // a nullptr
       MaterialHelper mat(trkr.material(), p.E());
-      if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+      if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
 
       // auto bound = trkr.boundary();
       while (p.is_alive()) {
         bool had_collision = false;
         auto maj_indx = EGrid->get_lower_index(p.E());
         double Emajorant =
-            Emaj->evaluate(p.E(), maj_indx) + mat.Ew(p.E(), noise);
+            Emaj->evaluate(p.E(), maj_indx) + mat.Ew(p.E(), Mode::noise);
         p.set_Esmp(Emajorant);  // Sampling XS saved for cancellation
         auto bound = trkr.get_boundary_condition();
 
@@ -207,7 +216,7 @@ std::vector<BankedParticle> ImplicitLeakageDeltaTracker::transport(
           mat.set_material(trkr.material(), p.E());
 
           // Get true cross section here
-          double Et = mat.Et(p.E(), noise);
+          double Et = mat.Et(p.E(), Mode::noise);
 
           if (Et - Emajorant > 1.E-10) {
             std::stringstream mssg;
@@ -224,10 +233,11 @@ std::vector<BankedParticle> ImplicitLeakageDeltaTracker::transport(
         }
 
         if (p.is_alive() && had_collision) {  // real collision
-          collision(p, mat, thread_scores, noise, noise_maker);
+          collision<Mode::noise, Mode::branchless>(p, mat, thread_scores,
+                                                 noise_maker);
           trkr.set_u(p.u());
           p.set_previous_collision_real();
-          if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+          if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
         } else if (p.is_alive()) {  // Virtual collision
           p.set_previous_collision_virtual();
         }
@@ -250,7 +260,7 @@ std::vector<BankedParticle> ImplicitLeakageDeltaTracker::transport(
               fatal_error(mssg.str());
             }
             mat.set_material(trkr.material(), p.E());
-            if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+            if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
           } else if (settings::rng_stride_warnings) {
             // History is truly dead.
             // Check if we went past the particle stride.
@@ -23,6 +23,7 @@
  *
  * */
 #include <geometry/boundary.hpp>
+#include <geometry/cell_universe.hpp>
 #include <geometry/geometry.hpp>
 #include <geometry/hex_lattice.hpp>
 #include <geometry/lattice.hpp>
@@ -30,7 +31,9 @@
 #include <geometry/surfaces/surface.hpp>
 #include <utils/error.hpp>
 
+#include <algorithm>
 #include <cstdint>
+#include <set>
 
 Lattice::Lattice(uint32_t i_id, std::string i_name)
     : Universe{i_id, i_name}, lattice_universes{}, outer_universe_index{-1} {
@@ -129,6 +132,45 @@ bool Lattice::contains_universe(uint32_t id) const {
   return false;
 }
 
+void Lattice::flatten() {
+  // A tile filled with a universe which only holds a single infinite cell,
+  // filled with yet another universe, can be filled with that last universe
+  // directly. The universe in between has a single cell with an offset of
+  // zero, so the instance numbering is unchanged.
+  auto collapse = [](int32_t& uni_indx) {
+    if (uni_indx < 0) return;
+
+    const auto* cell_uni = dynamic_cast<const CellUniverse*>(
+        geometry::universes[static_cast<std::size_t>(uni_indx)].get());
+    while (cell_uni && cell_uni->trivial_fill()) {
+      const Universe* fill = cell_uni->trivial_fill();
+      uni_indx = static_cast<int32_t>(universe_id_to_indx[fill->id()]);
+      cell_uni = dynamic_cast<const CellUniverse*>(fill);
+    }
+  };
+
+  for (auto& uni_indx : lattice_universes) collapse(uni_indx);
+  collapse(outer_universe_index);
+}
+
+uint32_t Lattice::depth() const {
+  // Only look at each universe once, as many tiles share the same one
+  std::set<int32_t> tile_universes(lattice_universes.begin(),
+                                   lattice_universes.end());
+  tile_universes.insert(outer_universe_index);
+
+  uint32_t max_depth = 0;
+  for (const auto& uni_indx : tile_universes) {
+    if (uni_indx < 0) continue;
+    max_depth = std::max(
+        max_depth,
+        geometry::universes[static_cast<std::size_t>(uni_indx)]->depth());
+  }
+
+  // Add the level of the lattice itself
+  return max_depth + 1;
+}
+
 uint32_t Lattice::get_num_cell_instances(uint32_t cell_id) const {
   uint32_t instances = 0;
 
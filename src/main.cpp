@@ -186,6 +186,12 @@ int main(int argc, char** argv) {
     print_header();
     Output::instance().write("\n");
 
+    // Get the checkpoint to restart from, if one was provided
+    if (args["--restart"]) {
+      settings::restart = true;
+      settings::restart_file_name = args["--restart"].asString();
+    }
+
     // Parse input file
     bool parsed_file = false;
     try {
@@ -26,8 +26,6 @@
 #include <utils/majorant.hpp>
 #include <utils/settings.hpp>
 
-#include <boost/unordered/unordered_flat_map.hpp>
-
 #include <PapillonNDL/energy_grid.hpp>
 #include <PapillonNDL/st_coherent_elastic.hpp>
 #include <PapillonNDL/st_incoherent_inelastic.hpp>
@@ -45,9 +43,8 @@ std::pair<std::vector<double>, std::vector<double>> make_majorant_xs() {
     // should be able to safely case a Nuclide pointer to a CENuclide pointer.
     std::vector<double> union_energy_grid;
 
-    // Get a map of all URR random values set to 1, for finding the majorant
-    boost::unordered_flat_map<uint32_t, std::optional<double>> urr_rands;
-    for (const auto& za : zaids_with_urr) urr_rands[za] = 1.;
+    // Get all URR random values set to 1, for finding the majorant
+    std::vector<double> urr_rands(urr_slots.size(), 1.);
 
     // Iterate through all nuclides
     for (const auto& id_nucld_pair : nuclides) {
@@ -201,10 +201,12 @@ Material::Material(double temperature, double density, DensityUnits dunits,
           nuclides[temp_frac.nuclide->id()] = temp_frac.nuclide;
         }
 
-        // If this is a new zaid with a URR, add it to the zaids with urr set
-        if (temp_frac.nuclide->has_urr() &&
-            zaids_with_urr.contains(temp_frac.nuclide->zaid()) == false) {
-          zaids_with_urr.insert(temp_frac.nuclide->zaid());
+        // If the nuclide has a URR, give it the slot of its zaid, making a
+        // new slot if this is a new zaid with a URR.
+        if (temp_frac.nuclide->has_urr()) {
+          auto slot = urr_slots.try_emplace(temp_frac.nuclide->zaid(),
+                                            urr_slots.size());
+          temp_frac.nuclide->set_urr_slot(slot.first->second);
         }
 
         components_.push_back(
@@ -219,10 +221,12 @@ Material::Material(double temperature, double density, DensityUnits dunits,
           nuclides[temp_frac.nuclide->id()] = temp_frac.nuclide;
         }
 
-        // If this is a new zaid with a URR, add it to the zaids with urr set
-        if (temp_frac.nuclide->has_urr() &&
-            zaids_with_urr.contains(temp_frac.nuclide->zaid()) == false) {
-          zaids_with_urr.insert(temp_frac.nuclide->zaid());
+        // If the nuclide has a URR, give it the slot of its zaid, making a
+        // new slot if this is a new zaid with a URR.
+        if (temp_frac.nuclide->has_urr()) {
+          auto slot = urr_slots.try_emplace(temp_frac.nuclide->zaid(),
+                                            urr_slots.size());
+          temp_frac.nuclide->set_urr_slot(slot.first->second);
         }
 
         components_.push_back(
@@ -26,15 +26,13 @@
 #include <materials/nuclide.hpp>
 
 MaterialHelper::MaterialHelper(Material* material, double E)
-    : mat(material), E_(E), xs_(), zaid_to_urr_rand_() {
+    : mat(material),
+      E_(E),
+      xs_(),
+      urr_rands_(urr_slots.size(), 0.),
+      has_urr_rands_(false) {
   // Add all nuclides to the xs_ map
   for (const auto& nuc : nuclides) {
     xs_[nuc.second.get()] = std::nullopt;
   }
-
-  // For all ZAIDs we found with a URR, add them to the
-  // zaid_to_urr_rand_ map
-  for (const auto& za : zaids_with_urr) {
-    zaid_to_urr_rand_[za] = std::nullopt;
-  }
-}
\ No newline at end of file
+}
@@ -30,9 +30,32 @@
 #include <utils/output.hpp>
 #include <utils/settings.hpp>
 
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <queue>
 #include <set>
+#include <sstream>
 #include <vector>
 
+#ifdef ABEILLE_USE_OMP
+#include <omp.h>
+#endif
+
+// Number of records a thread keeps before merging those of the same bins
+constexpr std::size_t RECORD_COMPACT_SIZE = 1 << 20;
+
+// Tag of the messages used to send score records to the tally servers
+constexpr int RECORDS_TAG = 5252;
+
+// Tag of the messages used to send the slices of the tally servers to master
+constexpr int SLICE_TAG = 5262;
+
+// Number of values in each message of a slice sent to master, and in each
+// chunk of the results of a sparse tally written to the output file
+constexpr uint64_t SLICE_CHUNK_SIZE = 1 << 24;
+
+
 const static std::set<std::string> disallowed_tally_names{
     "families",
     "pair-dist-sqrd",
@@ -58,9 +81,37 @@ const static std::set<std::string> disallowed_tally_names{
     "leakage",
     "mig-area"};
 
+MeshTallyStorage make_mesh_tally_storage(const YAML::Node& node) {
+  MeshTallyStorage storage;
+
+  if (node["storage"] && node["storage"].IsScalar()) {
+    const std::string storage_str = node["storage"].as<std::string>();
+    if (storage_str == "sparse") {
+      storage.sparse = true;
+    } else if (storage_str != "dense") {
+      fatal_error("Unknown mesh tally storage \"" + storage_str + "\".");
+    }
+  } else if (node["storage"]) {
+    fatal_error("Invalid storage entry provided to mesh tally.");
+  }
+
+  if (node["precision"] && node["precision"].IsScalar()) {
+    const std::string precision_str = node["precision"].as<std::string>();
+    if (precision_str == "single") {
+      storage.single_precision = true;
+    } else if (precision_str != "double") {
+      fatal_error("Unknown mesh tally precision \"" + precision_str + "\".");
+    }
+  } else if (node["precision"]) {
+    fatal_error("Invalid precision entry provided to mesh tally.");
+  }
+
+  return storage;
+}
+
 MeshTally::MeshTally(Position low, Position hi, uint64_t nx, uint64_t ny,
                      uint64_t nz, const std::vector<double>& ebounds,
-                     std::string fname)
+                     std::string fname, MeshTallyStorage storage)
     : r_low{low},
       r_hi{hi},
       Nx{nx},
@@ -76,9 +127,11 @@ MeshTally::MeshTally(Position low, Position hi, uint64_t nx, uint64_t ny,
       net_weight(1.),
       energy_bounds(ebounds),
       fname(fname),
+      storage(storage),
       tally_gen(),
       tally_avg(),
-      tally_var() {
+      tally_var(),
+      tally_batch() {
   // Make sure the name is allowed.
   if (disallowed_tally_names.contains(this->fname)) {
     fatal_error("The tally name " + this->fname + " is reserved.");
@@ -93,10 +146,65 @@ MeshTally::MeshTally(Position low, Position hi, uint64_t nx, uint64_t ny,
 
   uint32_t Ne = static_cast<uint32_t>(energy_bounds.size() - 1);
 
+  if (storage.sparse && settings::tally_servers > 0) {
+    fatal_error("The mesh tally " + this->fname +
+                " cannot use sparse storage with tally servers.");
+  }
+
+  if (settings::tally_servers > 0 || storage.sparse) {
+    // The scores are kept as records by each thread, so that no node needs
+    // a full copy of the tally.
+#ifdef ABEILLE_USE_OMP
+    thread_records.resize(static_cast<std::size_t>(omp_get_max_threads()));
+#else
+    thread_records.resize(1);
+#endif
+    for (auto& recs : thread_records) recs.compact_size = RECORD_COMPACT_SIZE;
+  }
+
+  if (storage.sparse) {
+    if (settings::stream_generations) {
+      warning("The generations of the sparse mesh tally " + this->fname +
+              " will not be streamed.");
+    }
+    batch_requests.resize(2);
+    write_memory_use();
+    return;
+  }
+
+  if (settings::tally_servers > 0) {
+    const std::size_t nservers =
+        static_cast<std::size_t>(settings::tally_servers);
+    server_bins.resize(nservers);
+    server_scores.resize(nservers);
+    server_requests.resize(2 * nservers);
+
+    // Servers only allocate their own planes
+    if (mpi::is_tally_server()) {
+      const int server = mpi::rank - mpi::first_tally_server();
+      first_plane = server_first_plane(server);
+      nplanes = server_first_plane(server + 1) - first_plane;
+
+      tally_batch.reallocate({nplanes, Ny, Nz});
+      tally_batch.fill(0.);
+
+      tally_avg.reallocate({nplanes, Ny, Nz});
+      tally_avg.fill(0.);
+
+      tally_var.reallocate({nplanes, Ny, Nz});
+      tally_var.fill(0.);
+    }
+    write_memory_use();
+    return;
+  }
+
   // Allocate and fill arrays to zero
   tally_gen.reallocate({Ne, Nx, Ny, Nz});
   tally_gen.fill(0.);
 
+  tally_batch.reallocate({Ne, Nx, Ny, Nz});
+  tally_batch.fill(0.);
+
   // Only allocate average and variance if we are the master !
   if (mpi::rank == 0) {
     tally_avg.reallocate({Ne, Nx, Ny, Nz});
@@ -105,44 +213,503 @@ MeshTally::MeshTally(Position low, Position hi, uint64_t nx, uint64_t ny,
     tally_var.reallocate({Ne, Nx, Ny, Nz});
     tally_var.fill(0.);
   }
+
+  write_memory_use();
+}
+
+void MeshTally::write_memory_use() const {
+  const uint64_t nbins = (energy_bounds.size() - 1) * Nx * Ny * Nz;
+  const double array_mb =
+      static_cast<double>(nbins * sizeof(double)) / (1024. * 1024.);
+
+  std::stringstream mssg;
+  mssg << " Mesh tally " << fname << " : " << std::fixed
+       << std::setprecision(1);
+  if (settings::tally_servers > 0) {
+    // The first servers have the most planes
+    const uint64_t total_planes = (energy_bounds.size() - 1) * Nx;
+    const uint64_t max_planes = server_first_plane(1) - server_first_plane(0);
+    mssg << 3. * array_mb * static_cast<double>(max_planes) /
+                static_cast<double>(total_planes)
+         << " MB on each tally server.\n";
+  } else if (storage.sparse) {
+    // Each node holds a (bin, score) pair for each scored bin of the batch,
+    // and master also holds the bin, average, and variance.
+    mssg << "sparse, 16 B per scored bin on each node, 40 B on master"
+         << " (dense storage would use " << 2. * array_mb
+         << " MB on each node, " << 4. * array_mb << " MB on master).\n";
+  } else {
+    mssg << 2. * array_mb << " MB on each node, " << 4. * array_mb
+         << " MB on master.\n";
+  }
+  Output::instance().write(mssg.str());
 }
 
 void MeshTally::set_net_weight(double W) { net_weight = W; }
 
+void MeshTally::set_stream_group(const std::string& group) {
+  stream_group = group;
+}
+
+// Sorts the records by bin, and sums the scores of records with the same bin
+static void compact_records(std::vector<std::pair<uint64_t, double>>& recs) {
+  if (recs.empty()) return;
+
+  std::sort(recs.begin(), recs.end(),
+            [](const auto& a, const auto& b) { return a.first < b.first; });
+
+  std::size_t last = 0;
+  for (std::size_t i = 1; i < recs.size(); i++) {
+    if (recs[i].first == recs[last].first) {
+      recs[last].second += recs[i].second;
+    } else {
+      recs[++last] = recs[i];
+    }
+  }
+  recs.resize(last + 1);
+}
+
+// Merges the bins and scores gathered from all nodes into batch, summing the
+// scores of the same bins. Each node sends its bins in increasing order, so
+// the values are made of sorted runs, which are merged without sorting them
+// all again.
+static void merge_runs(const std::vector<uint64_t>& bins,
+                       const std::vector<double>& scores,
+                       std::vector<std::pair<uint64_t, double>>& batch) {
+  // A new run starts wherever the bins stop increasing
+  using Run = std::pair<std::size_t, std::size_t>;
+  std::vector<Run> runs;
+  std::size_t begin = 0;
+  for (std::size_t i = 1; i <= bins.size(); i++) {
+    if (i == bins.size() || bins[i] <= bins[i - 1]) {
+      runs.push_back({begin, i});
+      begin = i;
+    }
+  }
+
+  // Heap of the runs, ordered by the next bin of each run
+  auto later = [&bins](const Run& a, const Run& b) {
+    return bins[a.first] > bins[b.first];
+  };
+  std::priority_queue<Run, std::vector<Run>, decltype(later)> heads(
+      later, std::move(runs));
+
+  batch.clear();
+  batch.reserve(bins.size());
+  while (!heads.empty()) {
+    auto [i, end] = heads.top();
+    heads.pop();
+
+    if (!batch.empty() && batch.back().first == bins[i]) {
+      batch.back().second += scores[i];
+    } else {
+      batch.push_back({bins[i], scores[i]});
+    }
+
+    if (++i < end) heads.push({i, end});
+  }
+}
+
 void MeshTally::record_generation(double multiplier) {
-  // Advance the number of generations
-  g++;
-  const double dg = static_cast<double>(g);
+  if (storage.sparse) {
+    // Record the last batch. Its gather has been in progress during the
+    // transport of this generation.
+    finish_reduction();
 
-  // All worker threads must send their generation score to the master.
-  // Master must recieve all generations scores from workers and add
-  // them to it's own generation score.
-  mpi::Reduce_sum(tally_gen.data_vector(), 0);
+    // Add the scores of this generation to the batch, which is kept sorted
+    // by bin
+    for (auto& recs : thread_records) {
+      for (const auto& [bin, scr] : recs.records) {
+        sparse_batch.push_back({bin, scr * multiplier});
+      }
+      recs.records.clear();
+    }
+    compact_records(sparse_batch);
+    batch_gens++;
 
-  // Only try to update average and variance is we are master, as worker
-  // processes don't have copies of this data, so it will seg-fault.
-  if (mpi::rank == 0) {
+    if (batch_gens == static_cast<uint64_t>(settings::tally_batch_size)) {
+      start_reduction();
+    }
+    return;
+  }
+
+  if (settings::tally_servers > 0) {
+    // Send the scores to the servers, where they are added to the batch
+    if (mpi::is_tally_server()) {
+      receive_records();
+    } else {
+      send_records(multiplier);
+    }
+    batch_gens++;
+
+    if (batch_gens == static_cast<uint64_t>(settings::tally_batch_size)) {
+      record_batch(batch_gens);
+      batch_gens = 0;
+    }
+    return;
+  }
+
+  // Record the last batch. Its reduction has been in progress during the
+  // transport of this generation, and it must be complete before the batch
+  // buffer is reused.
+  finish_reduction();
+
+  // Add the scores of this generation to the batch
+  if (batch_gens == 0) {
 #ifdef ABEILLE_USE_OMP
 #pragma omp parallel for schedule(static)
 #endif
     for (size_t i = 0; i < tally_gen.size(); i++) {
-      // Get new average
-      double old_avg = tally_avg[i];
-      double val = tally_gen[i] * multiplier;
-      double avg = old_avg + (val - old_avg) / dg;
-      tally_avg[i] = avg;
-
-      // Get new variance
-      double var = tally_var[i];
+      tally_batch[i] = tally_gen[i] * multiplier;
+    }
+  } else {
+#ifdef ABEILLE_USE_OMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (size_t i = 0; i < tally_gen.size(); i++) {
+      tally_batch[i] += tally_gen[i] * multiplier;
+    }
+  }
+  batch_gens++;
+
+  if (batch_gens == static_cast<uint64_t>(settings::tally_batch_size)) {
+    start_reduction();
+  }
+}
+
+void MeshTally::finish_batches() {
+  finish_reduction();
+
+  // Make sure all records have been sent to the servers
+  for (auto& req : server_requests) req.wait();
+
+  if (batch_gens > 0 && settings::tally_servers > 0) {
+    record_batch(batch_gens);
+    batch_gens = 0;
+  } else if (batch_gens > 0) {
+    start_reduction();
+    finish_reduction();
+  }
+}
+
+void MeshTally::gather_batch() {
+  finish_reduction();
+
+  if (batch_gens > 0 && storage.sparse) {
+    // Gather the batch on master, without recording it
+    start_reduction();
+    merge_sparse_batches();
+    batch_gens = reduce_gens;
+    reduce_gens = 0;
+  } else if (batch_gens > 0) {
+    mpi::Ireduce_sum(tally_batch.data_vector(), 0).wait();
+    if (mpi::rank != 0) tally_batch.fill(0.);
+  }
+}
+
+void MeshTally::start_reduction() {
+  // All worker threads must send their batch score to the master.
+  // Master must recieve all batch scores from workers and add
+  // them to it's own batch score.
+  reduce_gens = batch_gens;
+  batch_gens = 0;
+
+  if (!storage.sparse) {
+    reduce_request = mpi::Ireduce_sum(tally_batch.data_vector(), 0);
+    return;
+  }
+
+  // Sparse batches are gathered on master, which merges them once the
+  // gather is complete.
+  batch_bins.clear();
+  batch_scores.clear();
+  batch_bins.reserve(sparse_batch.size());
+  batch_scores.reserve(sparse_batch.size());
+  for (const auto& [bin, scr] : sparse_batch) {
+    batch_bins.push_back(bin);
+    batch_scores.push_back(scr);
+  }
+  sparse_batch.clear();
+
+  batch_requests[0] = mpi::Igatherv(batch_bins, 0);
+  batch_requests[1] = mpi::Igatherv(batch_scores, 0);
+}
+
+void MeshTally::finish_reduction() {
+  if (reduce_gens == 0) return;
+  if (storage.sparse) {
+    merge_sparse_batches();
+  } else {
+    reduce_request.wait();
+  }
+  record_batch(reduce_gens);
+  reduce_gens = 0;
+}
+
+void MeshTally::merge_sparse_batches() {
+  for (auto& req : batch_requests) req.wait();
+
+  if (mpi::rank == 0) merge_runs(batch_bins, batch_scores, sparse_batch);
+  batch_bins.clear();
+  batch_scores.clear();
+}
+
+void MeshTally::record_batch(uint64_t ngens) {
+  // Advance the number of batches. Each batch is one sample of the average
+  // score per generation.
+  g++;
+  const double dg = static_cast<double>(g);
+  const double inv_gens = 1. / static_cast<double>(ngens);
+
+  // Only master, or the tally servers, have copies of the average and
+  // variance to update.
+  const bool has_stats = settings::tally_servers > 0 ? mpi::is_tally_server()
+                                                     : mpi::rank == 0;
+  if (!has_stats) return;
+
+  if (storage.sparse) {
+    // The bins which were not scored in this batch have a score of zero, so
+    // the statistics of all the bins scored so far are updated. Bins scored
+    // for the first time start with an average and variance of zero, which
+    // are those of the previous batches.
+    std::vector<uint64_t> bins;
+    std::vector<double> avgs;
+    std::vector<double> vars;
+    const std::size_t nmax = sparse_bins.size() + sparse_batch.size();
+    bins.reserve(nmax);
+    avgs.reserve(nmax);
+    vars.reserve(nmax);
+
+    std::size_t i = 0;
+    std::size_t j = 0;
+    while (i < sparse_bins.size() || j < sparse_batch.size()) {
+      const bool in_stats =
+          i < sparse_bins.size() &&
+          (j == sparse_batch.size() || sparse_bins[i] <= sparse_batch[j].first);
+      const bool in_batch =
+          j < sparse_batch.size() &&
+          (i == sparse_bins.size() || sparse_batch[j].first <= sparse_bins[i]);
+
+      uint64_t bin = 0;
+      double old_avg = 0.;
+      double var = 0.;
+      double val = 0.;
+      if (in_stats) {
+        bin = sparse_bins[i];
+        old_avg = sparse_avg[i];
+        var = sparse_var[i];
+        i++;
+      }
+      if (in_batch) {
+        bin = sparse_batch[j].first;
+        val = sparse_batch[j].second * inv_gens;
+        j++;
+      }
+
+      const double avg = old_avg + (val - old_avg) / dg;
       var = var + (((val - old_avg) * (val - avg) - (var)) / dg);
-      tally_var[i] = var;
+      bins.push_back(bin);
+      avgs.push_back(avg);
+      vars.push_back(var);
+    }
+
+    sparse_bins.swap(bins);
+    sparse_avg.swap(avgs);
+    sparse_var.swap(vars);
+    sparse_batch.clear();
+    return;
+  }
+
+#ifdef ABEILLE_USE_OMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (size_t i = 0; i < tally_batch.size(); i++) {
+    // Get new average
+    double old_avg = tally_avg[i];
+    double val = tally_batch[i] * inv_gens;
+    double avg = old_avg + (val - old_avg) / dg;
+    tally_avg[i] = avg;
+
+    // Get new variance
+    double var = tally_var[i];
+    var = var + (((val - old_avg) * (val - avg) - (var)) / dg);
+    tally_var[i] = var;
+  }
+
+  // Stream the scores of this batch to the output file. Only master can
+  // write to it, so this isn't done with tally servers.
+  if (settings::stream_generations && mpi::rank == 0) {
+    std::vector<double> row = tally_batch.data_vector();
+    for (auto& val : row) val *= inv_gens;
+    const std::size_t nbytes = row.size() * sizeof(double);
+    Output::instance().write_async(
+        [name = stream_group + "/" + fname, row = std::move(row),
+         shape = tally_batch.shape()](H5::File& h5) {
+          append_row(h5, name, row, shape);
+        },
+        nbytes);
+  }
+}
+
+void MeshTally::record_score(uint64_t bin, double scr) {
+#ifdef ABEILLE_USE_OMP
+  auto& recs = thread_records[static_cast<std::size_t>(omp_get_thread_num())];
+#else
+  auto& recs = thread_records[0];
+#endif
+  recs.records.push_back({bin, scr});
+
+  // Merge the records of the same bins once there are many. If that doesn't
+  // free much room, many different bins are being scored, so we wait for
+  // twice as many records before trying again.
+  if (recs.records.size() >= recs.compact_size) {
+    compact_records(recs.records);
+    if (recs.records.size() > recs.compact_size / 2) recs.compact_size *= 2;
+  }
+}
+
+uint64_t MeshTally::server_first_plane(int server) const {
+  // The planes are split evenly, with the remainder going to the first
+  // servers.
+  const uint64_t total_planes = (energy_bounds.size() - 1) * Nx;
+  const uint64_t nservers = static_cast<uint64_t>(settings::tally_servers);
+  const uint64_t base = total_planes / nservers;
+  const uint64_t remainder = total_planes % nservers;
+  const uint64_t s = static_cast<uint64_t>(server);
+  return s * base + std::min(s, remainder);
+}
+
+int MeshTally::plane_owner(uint64_t plane) const {
+  const uint64_t total_planes = (energy_bounds.size() - 1) * Nx;
+  const uint64_t nservers = static_cast<uint64_t>(settings::tally_servers);
+  const uint64_t base = total_planes / nservers;
+  const uint64_t remainder = total_planes % nservers;
+
+  // The first remainder servers own base + 1 planes each
+  if (plane < remainder * (base + 1)) {
+    return static_cast<int>(plane / (base + 1));
+  }
+  return static_cast<int>(remainder + (plane - remainder * (base + 1)) / base);
+}
+
+void MeshTally::send_records(double multiplier) {
+  // The records of the last generation must have been sent before the
+  // buffers are reused.
+  for (auto& req : server_requests) req.wait();
+  for (auto& bins : server_bins) bins.clear();
+  for (auto& scores : server_scores) scores.clear();
+
+  const uint64_t plane_size = Ny * Nz;
+  for (auto& recs : thread_records) {
+    compact_records(recs.records);
+    for (const auto& [bin, scr] : recs.records) {
+      const std::size_t s =
+          static_cast<std::size_t>(plane_owner(bin / plane_size));
+      server_bins[s].push_back(bin);
+      server_scores[s].push_back(scr * multiplier);
     }
+    recs.records.clear();
   }
+
+  // Start sending the records. They are only waited on at the next
+  // generation, so that the transport can continue in the meantime.
+  for (std::size_t s = 0; s < server_bins.size(); s++) {
+    const int server = mpi::first_tally_server() + static_cast<int>(s);
+    server_requests[2 * s] =
+        mpi::Isend(server_bins[s], server, RECORDS_TAG);
+    server_requests[2 * s + 1] =
+        mpi::Isend(server_scores[s], server, RECORDS_TAG + 2);
+  }
+}
+
+void MeshTally::receive_records() {
+  // Start a new batch, if needed
+  if (batch_gens == 0) tally_batch.fill(0.);
+
+  const uint64_t first_bin = first_plane * Ny * Nz;
+  std::vector<uint64_t> bins;
+  std::vector<double> scores;
+  for (int n = 0; n < mpi::first_tally_server(); n++) {
+    mpi::Recv(bins, n, RECORDS_TAG);
+    mpi::Recv(scores, n, RECORDS_TAG + 2);
+    for (std::size_t i = 0; i < bins.size(); i++) {
+      tally_batch[bins[i] - first_bin] += scores[i];
+    }
+  }
+
+  // Servers transport no particles, so they have no records of their own
+  for (auto& recs : thread_records) recs.records.clear();
 }
 
-void MeshTally::clear_generation() { tally_gen.fill(0.); }
+void MeshTally::clear_generation() {
+  tally_gen.fill(0.);
+
+  // Drop the records of generations which were not recorded
+  for (auto& recs : thread_records) recs.records.clear();
+}
+
+// Number of planes sent in each message of a slice, or written in each chunk
+// of sparse results
+static uint64_t slice_chunk_planes(uint64_t plane_size) {
+  return std::max<uint64_t>(1, SLICE_CHUNK_SIZE / plane_size);
+}
+
+// Creates a dataset for the results of a tally, in single or double precision
+static H5::DataSet create_results_dataset(H5::Group& grp,
+                                          const std::string& name,
+                                          const std::vector<std::size_t>& shape,
+                                          bool single_precision) {
+  if (single_precision) {
+    return grp.createDataSet<float>(name, H5::DataSpace(shape));
+  }
+  return grp.createDataSet<double>(name, H5::DataSpace(shape));
+}
+
+// Writes the planes [first, first + n) of a dataset of shape (Ne, Nx, Ny,
+// Nz), where plane p holds the (y, z) values of energy group p / Nx and x
+// index p % Nx. This is done with at most three hyperslabs. The values are
+// converted to floats for a single precision dataset.
+static void write_planes(H5::DataSet& dset, uint64_t Nx, uint64_t Ny,
+                         uint64_t Nz, uint64_t first, uint64_t n,
+                         const double* vals, bool single_precision) {
+  while (n > 0) {
+    const uint64_t e = first / Nx;
+    const uint64_t x = first % Nx;
+
+    // Write whole energy groups when possible, and otherwise the planes up
+    // to the end of the current energy group.
+    uint64_t ne = 1;
+    uint64_t nx = std::min(n, Nx - x);
+    if (x == 0 && n >= Nx) {
+      ne = n / Nx;
+      nx = Nx;
+    }
+
+    auto slab = dset.select({e, x, 0, 0}, {ne, nx, Ny, Nz});
+    const uint64_t nvals = ne * nx * Ny * Nz;
+    if (single_precision) {
+      std::vector<float> fvals(nvals);
+      for (uint64_t i = 0; i < nvals; i++) {
+        fvals[i] = static_cast<float>(vals[i]);
+      }
+      slab.write_raw(fvals.data());
+    } else {
+      slab.write_raw(vals);
+    }
+
+    vals += nvals;
+    first += ne * nx;
+    n -= ne * nx;
+  }
+}
+
+void MeshTally::write_tally(const std::string& group) {
+  // Tally servers send their slices of the mean and variance to master
+  if (settings::tally_servers > 0 && mpi::is_tally_server()) {
+    send_slice();
+    return;
+  }
 
-void MeshTally::write_tally() {
   // Only master can write tallies, as only master has a copy
   // of the mean and variance.
   if (mpi::rank != 0) return;
@@ -150,7 +717,7 @@ void MeshTally::write_tally() {
   auto& h5 = Output::instance().h5();
 
   // Create the group for the tally
-  auto tally_grp = h5.createGroup("results/" + this->fname);
+  auto tally_grp = h5.createGroup(group + "/" + this->fname);
 
   // First write coordinates and number of groups
   std::vector<double> x_bounds(Nx + 1, 0.);
@@ -183,16 +750,214 @@ void MeshTally::write_tally() {
   // Save the estimator
   tally_grp.createAttribute("estimator", this->estimator_str());
 
+  // Add data sets for the average and the standard deviation
+  const uint64_t Ne = energy_bounds.size() - 1;
+  const std::vector<std::size_t> shape{Ne, Nx, Ny, Nz};
+  auto avg_dset = create_results_dataset(tally_grp, "avg", shape,
+                                         storage.single_precision);
+  auto std_dset = create_results_dataset(tally_grp, "std", shape,
+                                         storage.single_precision);
+
+  if (settings::tally_servers > 0) {
+    receive_slices(avg_dset, std_dset);
+    return;
+  } else if (storage.sparse) {
+    write_sparse_results(avg_dset, std_dset);
+    return;
+  }
+
   // Convert flux_var to the error on the mean
   for (size_t l = 0; l < tally_var.size(); l++)
     tally_var[l] = std::sqrt(tally_var[l] / static_cast<double>(g));
 
-  // Add data sets for the average and the standard deviation
+  write_planes(avg_dset, Nx, Ny, Nz, 0, Ne * Nx, &tally_avg[0],
+               storage.single_precision);
+  write_planes(std_dset, Nx, Ny, Nz, 0, Ne * Nx, &tally_var[0],
+               storage.single_precision);
+}
+
+void MeshTally::write_sparse_results(H5::DataSet& avg_dset,
+                                     H5::DataSet& std_dset) const {
+  // The results are written in chunks of planes, so that the full dense
+  // arrays are never held in memory.
+  const uint64_t plane_size = Ny * Nz;
+  const uint64_t chunk_planes = slice_chunk_planes(plane_size);
+  const uint64_t total_planes = (energy_bounds.size() - 1) * Nx;
+
+  std::vector<double> avg;
+  std::vector<double> err;
+  std::size_t i = 0;
+  for (uint64_t p = 0; p < total_planes; p += chunk_planes) {
+    const uint64_t n = std::min(chunk_planes, total_planes - p);
+    const uint64_t begin = p * plane_size;
+    const uint64_t end = begin + n * plane_size;
+    avg.assign(end - begin, 0.);
+    err.assign(end - begin, 0.);
+
+    for (; i < sparse_bins.size() && sparse_bins[i] < end; i++) {
+      avg[sparse_bins[i] - begin] = sparse_avg[i];
+      err[sparse_bins[i] - begin] =
+          std::sqrt(sparse_var[i] / static_cast<double>(g));
+    }
+
+    write_planes(avg_dset, Nx, Ny, Nz, p, n, avg.data(),
+                 storage.single_precision);
+    write_planes(std_dset, Nx, Ny, Nz, p, n, err.data(),
+                 storage.single_precision);
+  }
+}
+
+void MeshTally::send_slice() const {
+  const uint64_t plane_size = Ny * Nz;
+  const uint64_t chunk_planes = slice_chunk_planes(plane_size);
+
+  std::vector<double> avg;
+  std::vector<double> err;
+  for (uint64_t p = 0; p < nplanes; p += chunk_planes) {
+    const uint64_t begin = p * plane_size;
+    const uint64_t end = std::min(p + chunk_planes, nplanes) * plane_size;
+    avg.assign(&tally_avg[0] + begin, &tally_avg[0] + end);
+
+    // Convert the variance to the error on the mean
+    err.resize(end - begin);
+    for (uint64_t i = begin; i < end; i++) {
+      err[i - begin] = std::sqrt(tally_var[i] / static_cast<double>(g));
+    }
+
+    mpi::Send(avg, 0, SLICE_TAG);
+    mpi::Send(err, 0, SLICE_TAG + 2);
+  }
+}
+
+void MeshTally::receive_slices(H5::DataSet& avg_dset,
+                               H5::DataSet& std_dset) const {
+  const uint64_t plane_size = Ny * Nz;
+  const uint64_t chunk_planes = slice_chunk_planes(plane_size);
+
+  std::vector<double> avg;
+  std::vector<double> err;
+  for (int s = 0; s < settings::tally_servers; s++) {
+    const int server = mpi::first_tally_server() + s;
+    const uint64_t server_first = server_first_plane(s);
+    const uint64_t server_nplanes = server_first_plane(s + 1) - server_first;
+
+    for (uint64_t p = 0; p < server_nplanes; p += chunk_planes) {
+      mpi::Recv(avg, server, SLICE_TAG);
+      mpi::Recv(err, server, SLICE_TAG + 2);
+
+      const uint64_t n = avg.size() / plane_size;
+      write_planes(avg_dset, Nx, Ny, Nz, server_first + p, n, avg.data(),
+                   storage.single_precision);
+      write_planes(std_dset, Nx, Ny, Nz, server_first + p, n, err.data(),
+                   storage.single_precision);
+    }
+  }
+}
+
+void MeshTally::write_checkpoint(H5::Group& grp) const {
+  if (mpi::rank != 0) return;
+
+  auto tally_grp = grp.createGroup(this->fname);
+  tally_grp.createAttribute("generations", g);
+  tally_grp.createAttribute("batch-generations", batch_gens);
+
+  if (storage.sparse) {
+    // The unfinished batch, which has been summed on master by gather_batch
+    if (batch_gens > 0) {
+      std::vector<uint64_t> bins;
+      std::vector<double> scores;
+      for (const auto& [bin, scr] : sparse_batch) {
+        bins.push_back(bin);
+        scores.push_back(scr);
+      }
+      tally_grp.createDataSet("batch-bins", bins);
+      tally_grp.createDataSet("batch", scores);
+    }
+
+    tally_grp.createDataSet("bins", sparse_bins);
+    tally_grp.createDataSet("avg", sparse_avg);
+    tally_grp.createDataSet("var", sparse_var);
+    return;
+  }
+
+  // The unfinished batch, which has been summed on master by gather_batch
+  if (batch_gens > 0) {
+    auto batch_dset = tally_grp.createDataSet<double>(
+        "batch", H5::DataSpace(tally_batch.shape()));
+    batch_dset.write_raw(&tally_batch[0]);
+  }
+
   auto avg_dset =
       tally_grp.createDataSet<double>("avg", H5::DataSpace(tally_avg.shape()));
   avg_dset.write_raw(&tally_avg[0]);
 
-  auto std_dset =
-      tally_grp.createDataSet<double>("std", H5::DataSpace(tally_var.shape()));
-  std_dset.write_raw(&tally_var[0]);
+  auto var_dset =
+      tally_grp.createDataSet<double>("var", H5::DataSpace(tally_var.shape()));
+  var_dset.write_raw(&tally_var[0]);
+}
+
+void MeshTally::read_checkpoint(const H5::Group& grp) {
+  if (!grp.exist(this->fname)) {
+    fatal_error("The checkpoint has no data for the tally " + this->fname +
+                ".");
+  }
+
+  auto tally_grp = grp.getGroup(this->fname);
+  if (tally_grp.exist("bins") != storage.sparse) {
+    fatal_error("The checkpoint data for the tally " + this->fname +
+                " does not match the storage of the tally.");
+  }
+  g = tally_grp.getAttribute("generations").read<uint64_t>();
+  batch_gens = tally_grp.getAttribute("batch-generations").read<uint64_t>();
+
+  // Master holds the sum of the unfinished batch over all nodes
+  tally_batch.fill(0.);
+  sparse_batch.clear();
+  if (mpi::rank != 0) return;
+
+  if (storage.sparse) {
+    if (batch_gens > 0) {
+      const auto bins =
+          tally_grp.getDataSet("batch-bins").read<std::vector<uint64_t>>();
+      const auto scores =
+          tally_grp.getDataSet("batch").read<std::vector<double>>();
+      if (bins.size() != scores.size()) {
+        fatal_error("The checkpoint data for the tally " + this->fname +
+                    " is inconsistent.");
+      }
+      for (std::size_t i = 0; i < bins.size(); i++) {
+        sparse_batch.push_back({bins[i], scores[i]});
+      }
+    }
+
+    sparse_bins = tally_grp.getDataSet("bins").read<std::vector<uint64_t>>();
+    sparse_avg = tally_grp.getDataSet("avg").read<std::vector<double>>();
+    sparse_var = tally_grp.getDataSet("var").read<std::vector<double>>();
+    if (sparse_avg.size() != sparse_bins.size() ||
+        sparse_var.size() != sparse_bins.size()) {
+      fatal_error("The checkpoint data for the tally " + this->fname +
+                  " is inconsistent.");
+    }
+    return;
+  }
+
+  if (batch_gens > 0) {
+    auto batch_dset = tally_grp.getDataSet("batch");
+    if (batch_dset.getDimensions() != tally_batch.shape()) {
+      fatal_error("The checkpoint data for the tally " + this->fname +
+                  " does not match the shape of the tally.");
+    }
+    batch_dset.read_raw<double>(&tally_batch[0]);
+  }
+
+  auto avg_dset = tally_grp.getDataSet("avg");
+  auto var_dset = tally_grp.getDataSet("var");
+  if (avg_dset.getDimensions() != tally_avg.shape() ||
+      var_dset.getDimensions() != tally_var.shape()) {
+    fatal_error("The checkpoint data for the tally " + this->fname +
+                " does not match the shape of the tally.");
+  }
+
+  avg_dset.read_raw<double>(&tally_avg[0]);
+  var_dset.read_raw<double>(&tally_var[0]);
 }
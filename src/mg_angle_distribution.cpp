@@ -27,15 +27,22 @@
 #include <utils/error.hpp>
 
 #include <algorithm>
+#include <functional>
 #include <sstream>
 
 MGAngleDistribution::MGAngleDistribution()
-    : mu_({-1., 1.}), pdf_({0.5, 0.5}), cdf_({0., 1.}) {}
+    : mu_({-1., 1.}),
+      pdf_({0.5, 0.5}),
+      cdf_({0., 1.}),
+      guide_(),
+      isotropic_(true) {
+  make_guide();
+}
 
 MGAngleDistribution::MGAngleDistribution(const std::vector<double>& mu,
                                          const std::vector<double>& pdf,
                                          const std::vector<double>& cdf)
-    : mu_(mu), pdf_(pdf), cdf_(cdf) {
+    : mu_(mu), pdf_(pdf), cdf_(cdf), guide_(), isotropic_(false) {
   // Make sure good mu bounds
   if (mu_.front() < -1.) {
     fatal_error("Angle limit less than -1.");
@@ -77,4 +84,22 @@ MGAngleDistribution::MGAngleDistribution(const std::vector<double>& mu,
   if (cdf_.back() != 1.) {
     fatal_error("Last CDF value is not 1.");
   }
+
+  // The pdf is clamped outside of [mu_.front(), mu_.back()], so a flat
+  // table is flat for all scattering cosines.
+  isotropic_ = std::adjacent_find(pdf_.begin(), pdf_.end(),
+                                  std::not_equal_to<double>()) == pdf_.end();
+
+  make_guide();
+}
+
+void MGAngleDistribution::make_guide() {
+  // One guide bin per CDF interval, so that each bin holds about one point
+  const std::size_t G = cdf_.size() - 1;
+  guide_.resize(G + 1);
+  for (std::size_t k = 0; k <= G; k++) {
+    const double c = static_cast<double>(k) / static_cast<double>(G);
+    auto cdf_it = std::lower_bound(cdf_.begin(), cdf_.end(), c);
+    guide_[k] = static_cast<std::size_t>(std::distance(cdf_.begin(), cdf_it));
+  }
 }
@@ -29,9 +29,9 @@
 #include <utils/rng.hpp>
 #include <utils/settings.hpp>
 
+#include <algorithm>
 #include <complex>
 #include <cstdint>
-#include <functional>
 #include <sstream>
 
 MGNuclide::MGNuclide(const std::vector<double>& speeds,
@@ -68,6 +68,51 @@ MGNuclide::MGNuclide(const std::vector<double>& speeds,
   check_fission_data();
   check_dealyed_data();
   check_fissile();
+
+  make_sampling_tables();
+}
+
+// Returns the normalized running sum of the weights. If the weights can't
+// be normalized, the first index will always be sampled.
+static std::vector<double> make_cdf(const std::vector<double>& weights) {
+  std::vector<double> cdf(weights.size(), 1.);
+
+  double sum = 0.;
+  for (const auto& w : weights) sum += w;
+  if (!(sum > 0.)) return cdf;
+
+  double running_sum = 0.;
+  std::size_t last = 0;
+  for (std::size_t i = 0; i < weights.size(); i++) {
+    running_sum += weights[i];
+    cdf[i] = running_sum / sum;
+    if (weights[i] > 0.) last = i;
+  }
+
+  // Make sure the last possible index is always reached, regardless of the
+  // rounding in the running sum.
+  for (std::size_t i = last; i < cdf.size(); i++) cdf[i] = 1.;
+
+  return cdf;
+}
+
+// Samples an index from a table made by make_cdf. Indices with a zero
+// weight can't be sampled, as their CDF equals that of the previous index.
+static std::size_t sample_cdf(const std::vector<double>& cdf, pcg32& rng) {
+  const double xi = RNG::rand(rng);
+  auto cdf_it = std::upper_bound(cdf.begin(), cdf.end(), xi);
+  return static_cast<std::size_t>(std::distance(cdf.begin(), cdf_it));
+}
+
+void MGNuclide::make_sampling_tables() {
+  Ps_cdf_.clear();
+  chi_cdf_.clear();
+  Ps_cdf_.reserve(Ps_.size());
+  chi_cdf_.reserve(chi_.size());
+
+  for (const auto& Ps_row : Ps_) Ps_cdf_.push_back(make_cdf(Ps_row));
+  for (const auto& chi_row : chi_) chi_cdf_.push_back(make_cdf(chi_row));
+  P_delayed_group_cdf_ = make_cdf(P_delayed_group);
 }
 
 void MGNuclide::normalize_chi() {
@@ -443,8 +488,7 @@ ScatterInfo MGNuclide::sample_scatter(double /*Ein*/, const Direction& u,
                                       const MicroXSs& micro_xs,
                                       pcg32& rng) const {
   // Change particle energy
-  std::size_t ei =
-      static_cast<std::size_t>(RNG::discrete(rng, Ps_[micro_xs.energy_index]));
+  std::size_t ei = sample_cdf(Ps_cdf_[micro_xs.energy_index], rng);
   double E_out =
       0.5 * (settings::energy_bounds[ei] + settings::energy_bounds[ei + 1]);
 
@@ -470,10 +514,8 @@ ScatterInfo MGNuclide::sample_scatter_mt(uint32_t /*mt*/, double Ein,
 
 FissionInfo MGNuclide::sample_prompt_fission(double /*Ein*/, const Direction& u,
                                              std::size_t i, pcg32& rng) const {
-  std::function<double()> rngfunc = std::bind(RNG::rand, std::ref(rng));
-
   // First we sample the the energy index
-  std::size_t ei = static_cast<std::size_t>(RNG::discrete(rng, chi_[i]));
+  std::size_t ei = sample_cdf(chi_cdf_[i], rng);
 
   // Put fission energy in middle of sampled bin
   double E_out =
@@ -504,13 +546,10 @@ FissionInfo MGNuclide::sample_delayed_fission(double Ein, const Direction& u,
 FissionInfo MGNuclide::sample_fission(double /*Ein*/, const Direction& u,
                                       std::size_t energy_index, double Pdelayed,
                                       pcg32& rng) const {
-  std::function<double()> rngfunc = std::bind(RNG::rand, std::ref(rng));
-
   FissionInfo info;
 
   // First we sample the the energy index
-  std::size_t ei =
-      static_cast<std::size_t>(RNG::discrete(rng, chi_[energy_index]));
+  std::size_t ei = sample_cdf(chi_cdf_[energy_index], rng);
 
   // Put fission energy in middle of sampled bin
   double E_out =
@@ -528,11 +567,10 @@ FissionInfo MGNuclide::sample_fission(double /*Ein*/, const Direction& u,
   info.precursor_decay_constant = 0.;
 
   // Next, we need to see if this is a delayed neutron or not.
-  if (rngfunc() < Pdelayed) {
+  if (RNG::rand(rng) < Pdelayed) {
     // We have a delayed neutron. We now need to select a delayed group
     // and get the group decay constant.
-    std::size_t dgrp =
-        static_cast<std::size_t>(RNG::discrete(rng, P_delayed_group));
+    std::size_t dgrp = sample_cdf(P_delayed_group_cdf_, rng);
     double lambda = delayed_group_decay_constants[dgrp];
 
     info.delayed = true;
@@ -25,8 +25,13 @@
 #include <simulation/particle.hpp>
 #include <utils/error.hpp>
 #include <utils/mpi.hpp>
+#include <utils/settings.hpp>
 
+#include <algorithm>
+#include <cstddef>
+#include <numeric>
 #include <type_traits>
+#include <utility>
 
 #ifdef ABEILLE_USE_MPI
 #include <mpi.h>
@@ -43,6 +48,7 @@ const DType Int = MPI_INT;
 const DType Double = MPI_DOUBLE;
 const DType UInt64 = MPI_UINT64_T;
 DType BParticle;
+DType BParticleCore;
 
 const OpType Sum = MPI_SUM;
 const OpType And = MPI_LAND;
@@ -50,11 +56,32 @@ const OpType Or = MPI_LOR;
 #endif
 
 std::vector<uint64_t> node_nparticles;
+std::vector<double> rank_weights;
 std::vector<uint64_t> node_nparticles_noise;
 
 int size = 1;
 int rank = 0;
 
+#ifdef ABEILLE_USE_MPI
+// Creates and commits a type with the first nmembers members of
+// BankedParticle, which has the extent of an entire BankedParticle.
+static void commit_banked_particle_type(int nmembers, const int* sizes,
+                                        const MPI_Aint* disps,
+                                        const DType* dtypes, DType& type) {
+  DType tmp_BParticle;
+  int err = MPI_Type_create_struct(nmembers, sizes, disps, dtypes,
+                                   &tmp_BParticle);
+  check_error(err, std::source_location::current());
+
+  err = MPI_Type_create_resized(
+      tmp_BParticle, 0, static_cast<MPI_Aint>(sizeof(BankedParticle)), &type);
+  check_error(err, std::source_location::current());
+
+  err = MPI_Type_commit(&type);
+  check_error(err, std::source_location::current());
+}
+#endif
+
 void register_banked_particle_type() {
 #ifdef ABEILLE_USE_MPI
   // Ensure that BankedParticle is standard layout ! This is
@@ -62,8 +89,8 @@ void register_banked_particle_type() {
   static_assert(std::is_standard_layout<BankedParticle>::value);
 
   BankedParticle p;
-  int err = 0;
   constexpr std::size_t BP_NUM_MEMBERS = 14;
+  constexpr std::size_t BP_NUM_CORE_MEMBERS = 8;
   int sizes[BP_NUM_MEMBERS]{3, 3, 1, 1, 1, 1, 1, 1, 1, 3, 3, 1, 1, 1};
   DType dtypes[BP_NUM_MEMBERS]{Double, Double, Double, Double, Double,
                                UInt64, UInt64, UInt64, Bool,   Double,
@@ -87,22 +114,27 @@ void register_banked_particle_type() {
     disps[i] -= disps[0];
   }
 
-  DType tmp_BParticle;
-  err = MPI_Type_create_struct(BP_NUM_MEMBERS, sizes, disps, dtypes,
-                               &tmp_BParticle);
-  check_error(err, std::source_location::current());
+  // The full type, with the info needed for cancellation
+  commit_banked_particle_type(BP_NUM_MEMBERS, sizes, disps, dtypes, BParticle);
 
-  MPI_Aint lb, extnt;
-  err = MPI_Type_get_extent(tmp_BParticle, &lb, &extnt);
-  check_error(err, std::source_location::current());
+  // The core type, with only the particle and its ids, which is all that is
+  // needed when cancellation isn't being performed.
+  commit_banked_particle_type(BP_NUM_CORE_MEMBERS, sizes, disps, dtypes,
+                              BParticleCore);
+#endif
+}
 
-  err = MPI_Type_create_resized(tmp_BParticle, lb, extnt, &BParticle);
-  check_error(err, std::source_location::current());
+#ifdef ABEILLE_USE_MPI
+template <>
+DType dtype<BankedParticle>() {
+  if (settings::regional_cancellation ||
+      settings::regional_cancellation_noise) {
+    return BParticle;
+  }
 
-  err = MPI_Type_commit(&BParticle);
-  check_error(err, std::source_location::current());
-#endif
+  return BParticleCore;
 }
+#endif
 
 void initialize_mpi(int* argc, char*** argv) {
   timer.reset();
@@ -151,6 +183,135 @@ void synchronize() {
 #endif
 }
 
+bool is_tally_server() { return rank >= first_tally_server(); }
+
+int first_tally_server() { return size - settings::tally_servers; }
+
+std::vector<uint64_t> split(uint64_t N) {
+  // Only the ranks before the tally servers are given values
+  const std::size_t nranks = static_cast<std::size_t>(first_tally_server());
+  std::vector<uint64_t> counts(static_cast<std::size_t>(size), 0);
+  std::fill_n(counts.begin(), nranks, N / nranks);
+
+  if (rank_weights.size() != counts.size()) {
+    // Distribute the remainder amongst the first ranks. There are at most
+    // nranks-1 remainder values.
+    const uint64_t remainder = N - (nranks * counts.front());
+    for (std::size_t n = 0; n < remainder; n++) counts[n]++;
+    return counts;
+  }
+
+  // Give each rank the whole part of its share, and then give the remaining
+  // values to the ranks with the largest fractional parts. All ranks have
+  // the same weights, so they all get the same split.
+  const auto weights_end =
+      rank_weights.begin() + static_cast<std::ptrdiff_t>(nranks);
+  const double tot_weight =
+      std::accumulate(rank_weights.begin(), weights_end, 0.);
+  std::vector<double> fractions(nranks, 0.);
+  uint64_t assigned = 0;
+  for (std::size_t n = 0; n < nranks; n++) {
+    const double share =
+        static_cast<double>(N) * (rank_weights[n] / tot_weight);
+    counts[n] = std::min(static_cast<uint64_t>(share), N - assigned);
+    fractions[n] = share - static_cast<double>(counts[n]);
+    assigned += counts[n];
+  }
+
+  std::vector<std::size_t> order(nranks);
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(),
+                   [&fractions](std::size_t i, std::size_t j) {
+                     return fractions[i] > fractions[j];
+                   });
+  for (std::size_t i = 0; assigned < N; i = (i + 1) % nranks) {
+    counts[order[i]]++;
+    assigned++;
+  }
+
+  return counts;
+}
+
+void update_rank_weights(uint64_t nparticles, double time,
+                         std::source_location loc) {
+  // Particles per second for this rank, or zero if we had nothing to time
+  double rate = 0.;
+  if (nparticles > 0 && time > 0.) {
+    rate = static_cast<double>(nparticles) / time;
+  }
+
+  std::vector<double> rates;
+  Allgather(rate, rates, loc);
+
+  const std::size_t nranks = static_cast<std::size_t>(size);
+  if (rank_weights.size() != nranks) {
+    // This is the first measurement, so we start from equal weights
+    double tot_rate = 0.;
+    std::size_t nmeasured = 0;
+    for (const double r : rates) {
+      if (r > 0.) {
+        tot_rate += r;
+        nmeasured++;
+      }
+    }
+    if (nmeasured == 0) return;
+    rank_weights.assign(nranks, tot_rate / static_cast<double>(nmeasured));
+  }
+
+  // Average with the previous weights, to damp the noise of a single
+  // generation. Ranks which had nothing to time keep their previous weight.
+  for (std::size_t n = 0; n < nranks; n++) {
+    if (rates[n] > 0.) rank_weights[n] = 0.5 * (rank_weights[n] + rates[n]);
+  }
+}
+
+Request::Request(Request&& other) noexcept
+    :
+#ifdef ABEILLE_USE_MPI
+      reqs_(std::move(other.reqs_)),
+#endif
+      finish_(std::move(other.finish_)),
+      pending_(std::exchange(other.pending_, false)) {
+}
+
+Request& Request::operator=(Request&& other) noexcept {
+  if (this != &other) {
+    // Make sure we don't drop an operation which is still in progress
+    if (pending_) wait();
+#ifdef ABEILLE_USE_MPI
+    reqs_ = std::move(other.reqs_);
+#endif
+    finish_ = std::move(other.finish_);
+    pending_ = std::exchange(other.pending_, false);
+  }
+  return *this;
+}
+
+Request::~Request() {
+  if (pending_) wait();
+}
+
+void Request::wait(std::source_location loc) {
+  if (!pending_) return;
+
+#ifdef ABEILLE_USE_MPI
+  timer.start();
+  int err = MPI_Waitall(static_cast<int>(reqs_.size()), reqs_.data(),
+                        MPI_STATUSES_IGNORE);
+  check_error(err, loc);
+  timer.stop();
+  reqs_.clear();
+#else
+  (void)loc;
+#endif
+
+  pending_ = false;
+  if (finish_) {
+    finish_();
+    finish_ = nullptr;
+  }
+}
+
 void check_error(int err, const std::source_location& loc) {
 #ifdef ABEILLE_USE_MPI
   if (err != MPI_SUCCESS) {
@@ -46,98 +46,13 @@ void Noise::initialize() {
   mpi::node_nparticles_noise.resize(static_cast<std::size_t>(mpi::size), 0);
 }
 
-void Noise::load_source_from_file() {
-  // Load source file
-  auto h5s = H5::File(settings::in_source_file_name, H5::File::ReadOnly);
-
-  // Get the dataset and dimensions
-  auto source_ds = h5s.getDataSet("source");
-  std::vector<std::size_t> dimensions = source_ds.getSpace().getDimensions();
-
-  // Check dimensions
-  if (dimensions.size() != 2 || dimensions[1] != 9) {
-    fatal_error("Invalid source from file dimensions.");
-  }
-
-  // Read in array
-  NDArray<double> source = NDArray<double>(dimensions);
-  source_ds.read<double>(&source[0]);
-
-  // Get number of particles
-  std::size_t Nprt = source.shape()[0];
-
-  // Calculate the base number of particles per node to run
-  uint64_t base_particles_per_node =
-      static_cast<uint64_t>(Nprt / static_cast<std::size_t>(mpi::size));
-  uint64_t remainder =
-      static_cast<uint64_t>(Nprt % static_cast<std::size_t>(mpi::size));
-
-  // Set the base number of particles per node in the node_nparticles vector
-  mpi::node_nparticles.resize(static_cast<std::size_t>(mpi::size),
-                              base_particles_per_node);
-
-  // Distribute the remainder particles amonst the nodes. There are at most
-  // mpi::size-1 remainder particles, so we will distribute them untill we
-  // have no more.
-  for (std::size_t rank = 0; rank < remainder; rank++) {
-    mpi::node_nparticles[rank]++;
-  }
-
-  // Now we need to make sure that the history_counter for each node is at
-  // the right starting location.
-  for (int lower_rank = 0; lower_rank < mpi::rank; lower_rank++) {
-    histories_counter +=
-        mpi::node_nparticles.at(static_cast<std::size_t>(lower_rank));
-  }
-
-  // Each node starts reading the input source data at their histories_counter
-  // index. It then reads its assigned number of particles.
-  uint64_t file_start_loc = histories_counter;
-  double tot_wgt = 0.;
-  for (std::size_t i = 0;
-       i < mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)]; i++) {
-    double x = source[(file_start_loc + i) * 9 + 0];
-    double y = source[(file_start_loc + i) * 9 + 1];
-    double z = source[(file_start_loc + i) * 9 + 2];
-    double ux = source[(file_start_loc + i) * 9 + 3];
-    double uy = source[(file_start_loc + i) * 9 + 4];
-    double uz = source[(file_start_loc + i) * 9 + 5];
-    double E = source[(file_start_loc + i) * 9 + 6];
-    double w = source[(file_start_loc + i) * 9 + 7];
-    double w2 = source[(file_start_loc + i) * 9 + 8];
-
-    bank.push_back({{x, y, z}, {ux, uy, uz}, E, w, histories_counter++});
-    bank.back().set_weight2(w2);
-    bank.back().initialize_rng(settings::rng_seed, settings::rng_stride);
-    tot_wgt += w;
-  }
-  global_histories_counter = Nprt;
-
-  mpi::Allreduce_sum(tot_wgt);
-
-  Output::instance().write(
-      " Total Weight of System: " + std::to_string(std::round(tot_wgt)) + "\n");
-  settings::nparticles = static_cast<int>(std::round(tot_wgt));
-  tallies->set_total_weight(std::round(tot_wgt));
-}
+void Noise::load_source_from_file() { load_source_file(bank); }
 
 void Noise::sample_source_from_sources() {
   Output::instance().write(" Generating source particles...\n");
-  // Calculate the base number of particles per node to run
-  uint64_t base_particles_per_node =
-      static_cast<uint64_t>(settings::nparticles / mpi::size);
-  uint64_t remainder = static_cast<uint64_t>(settings::nparticles % mpi::size);
-
-  // Set the base number of particles per node in the node_nparticles vector
-  mpi::node_nparticles.resize(static_cast<std::size_t>(mpi::size),
-                              base_particles_per_node);
-
-  // Distribute the remainder particles amonst the nodes. There are at most
-  // mpi::size-1 remainder particles, so we will distribute them untill we
-  // have no more.
-  for (std::size_t rank = 0; rank < remainder; rank++) {
-    mpi::node_nparticles[rank]++;
-  }
+  // Calculate the number of particles per node to run
+  mpi::node_nparticles =
+      mpi::split(static_cast<uint64_t>(settings::nparticles));
 
   // Now we need to make sure that the history_counter for each node is at
   // the right starting location.
@@ -265,9 +180,13 @@ void Noise::run() {
     power_iteration(true);
     power_iteration_timer.stop();
 
-    // The noise_bank is now populated with noise particles. We may now simulate
-    // these noise particles.
-    noise_simulation();
+    // The noise_bank is now populated with noise particles, for all of the
+    // frequencies. We may now simulate these noise particles, one frequency
+    // at a time.
+    for (std::size_t freq = 0; freq < frequency_tallies.size(); freq++) {
+      noise_simulation(freq);
+    }
+    noise_bank.clear();
 
     if (signaled) premature_kill();
 
@@ -299,20 +218,33 @@ void Noise::run() {
   out.write("\n Total Simulation Time: " +
             std::to_string(simulation_timer.elapsed_time()) + " seconds.\n");
 
-  // Write flux file
+  // Write flux file. The results of the first frequency are written in the
+  // results group, and those of the other frequencies in sub-groups.
   if (settings::converged && tallies->generations() > 0) {
     tallies->write_tallies();
+
+    for (std::size_t freq = 1; freq < frequency_tallies.size(); freq++) {
+      frequency_tallies[freq]->write_tallies("results/frequency-" +
+                                             std::to_string(freq));
+    }
   }
 }
 
 void Noise::power_iteration(bool sample_noise) {
   std::vector<BankedParticle> next_gen;
 
+  // The bank is cleared by the transport, so the number of particles is kept
+  // for the rank weights.
+  const uint64_t nprt = bank.size();
+  transport_timer.reset();
+  transport_timer.start();
   if (sample_noise == false) {
     next_gen = transporter->transport(bank, false, nullptr, nullptr);
   } else {
     next_gen = transporter->transport(bank, false, &noise_bank, &noise_maker);
   }
+  transport_timer.stop();
+  update_rank_weights(nprt);
   std::sort(next_gen.begin(), next_gen.end());
   mpi::synchronize();
 
@@ -324,8 +256,12 @@ void Noise::power_iteration(bool sample_noise) {
   // now have the particles that it will be responsible for.
   sync_banks(mpi::node_nparticles, next_gen);
 
-  // Get new keff
+  // Get new keff. The tallies are shared with the noise batches of the first
+  // frequency, so the values of the power iteration are streamed to their
+  // own group.
+  tallies->set_stream_group("generations/power-iteration");
   tallies->calc_gen_values();
+  tallies->set_stream_group("generations");
 
   // Zero tallies for next generation
   tallies->clear_generation();
@@ -421,9 +357,21 @@ inline void Noise::perform_regional_cancellation(
   sync_banks(nums, bank);
 }
 
-void Noise::noise_simulation() {
+void Noise::noise_simulation(std::size_t freq) {
+  // Noise transport depends on the frequency, through the copy cross section
+  // and the delayed neutrons. Scores go to the tallies of this frequency.
+  settings::w_noise = settings::noise_frequencies[freq];
+  std::shared_ptr<Tallies> ftallies = frequency_tallies[freq];
+  transporter->set_tallies(ftallies);
+
+  // Get the noise source particles of this frequency
+  std::vector<BankedParticle> fbank;
+  for (const auto& p : noise_bank) {
+    if (p.noise_frequency == freq) fbank.push_back(p);
+  }
+
   // First, we need to synchronize the initial noise souce bank
-  sync_banks(mpi::node_nparticles_noise, noise_bank);
+  sync_banks(mpi::node_nparticles_noise, fbank);
 
   uint64_t N_noise_tot = static_cast<uint64_t>(std::accumulate(
       mpi::node_nparticles_noise.begin(), mpi::node_nparticles_noise.end(), 0));
@@ -435,21 +383,23 @@ void Noise::noise_simulation() {
   out.write("\n -----------------------------------------------\n");
 
   // Need to keep copy of original so we can override garbage copy which
-  // will be produced in this noise batch.
+  // will be produced in this noise batch. The noise transport uses the
+  // kcol of the power iteration, for all frequencies.
   double original_kcol = tallies->kcol();
+  ftallies->set_kcol(original_kcol);
 
   double avg_wgt_mag = 1.;
   if (settings::normalize_noise_source) {
     // Normalize particle weights by the average weight magnitude.
     double sum_wgt_mag = 0.;
-    for (const auto& p : noise_bank) {
+    for (const auto& p : fbank) {
       sum_wgt_mag += std::sqrt(p.wgt * p.wgt + p.wgt2 * p.wgt2);
     }
 
     mpi::Allreduce_sum(sum_wgt_mag);
 
     avg_wgt_mag = sum_wgt_mag / static_cast<double>(N_noise_tot);
-    for (auto& p : noise_bank) {
+    for (auto& p : fbank) {
       p.wgt /= avg_wgt_mag;
       p.wgt2 /= avg_wgt_mag;
     }
@@ -460,9 +410,9 @@ void Noise::noise_simulation() {
   // rectord_generation on tallies with a multiplier of avg_wgt_mag,
   // we get the correct answer (as if we hadn't normalized noise
   // particle weights).
-  tallies->score_noise_source(noise_bank, settings::converged);
+  ftallies->score_noise_source(fbank, settings::converged);
 
-  // Cancellation may be performed on noise_bank here
+  // Cancellation may be performed on fbank here
 
   // Make sure we have the proper history_counter values at each node
   histories_counter = global_histories_counter;
@@ -473,13 +423,13 @@ void Noise::noise_simulation() {
 
   // Bank for noise particles.
   std::vector<Particle> nbank;
-  for (auto& p : noise_bank) {
+  for (auto& p : fbank) {
     nbank.emplace_back(p.r, p.u, p.E, p.wgt, p.wgt2, histories_counter++);
     nbank.back().initialize_rng(settings::rng_seed, settings::rng_stride);
   }
   global_histories_counter += static_cast<uint64_t>(std::accumulate(
       mpi::node_nparticles_noise.begin(), mpi::node_nparticles_noise.end(), 0));
-  noise_bank.clear();
+  fbank.clear();
 
   int noise_gen = 0;
   while (N_noise_tot != 0) {
@@ -489,8 +439,13 @@ void Noise::noise_simulation() {
     output << "  -- " << noise_gen << " running " << N_noise_tot
            << " particles \n";
 
+    const uint64_t nprt = nbank.size();
+    transport_timer.reset();
+    transport_timer.start();
     auto fission_bank = transporter->transport(nbank, true, nullptr, nullptr);
+    transport_timer.stop();
     if (noise_gen == 1) transported_histories += bank.size();
+    update_rank_weights(nprt);
     std::sort(fission_bank.begin(), fission_bank.end());
     mpi::synchronize();
 
@@ -536,23 +491,24 @@ void Noise::noise_simulation() {
   }
 
   // Get new values
-  tallies->calc_gen_values();
+  ftallies->calc_gen_values();
 
   // Keep values
-  tallies->record_generation(avg_wgt_mag);
+  ftallies->record_generation(avg_wgt_mag);
 
   // Zero tallies for next generation
-  tallies->clear_generation();
+  ftallies->clear_generation();
 
   // Clear particle banks
   nbank.clear();
 
   // Output
-  noise_output();
+  noise_output(freq);
 
   // So that a garbage kcol value isn't sent into PI and screws up the number
   // of particles to make a fissions.
   tallies->set_kcol(original_kcol);
+  transporter->set_tallies(tallies);
 
   out.write(" -----------------------------------------------\n\n");
 
@@ -614,7 +570,7 @@ void Noise::pi_generation_output() {
   Output::instance().write(output.str());
 }
 
-void Noise::noise_output() {
+void Noise::noise_output(std::size_t freq) {
   std::stringstream output;
 
   output << "\n";
@@ -623,6 +579,11 @@ void Noise::noise_output() {
   output << " Simulated noise batch " << noise_batch << "/"
          << settings::ngenerations << ".";
 
+  if (frequency_tallies.size() > 1) {
+    output << " Angular frequency " << settings::w_noise << " (" << freq + 1
+           << "/" << frequency_tallies.size() << ").";
+  }
+
   output << "\n";
 
   Output::instance().write(output.str());
@@ -31,9 +31,13 @@
 #include <utils/rng.hpp>
 
 #include <algorithm>
+#include <array>
+#include <cmath>
 #include <complex>
 #include <iterator>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <vector>
 
 void NoiseMaker::add_noise_source(const YAML::Node& snode) {
@@ -57,72 +61,221 @@ void NoiseMaker::add_noise_source(const YAML::Node& snode) {
   }
 }
 
-std::complex<double> NoiseMaker::dEt(const Particle& p, double w) const {
-  std::complex<double> dEt_to_return{0., 0.};
+void NoiseMaker::set_frequencies(const std::vector<double>& w) {
+  w_ = w;
+
+  for (auto& ns : vibration_noise_sources_) ns->set_frequencies(w_);
 
+  for (auto& ns : oscillation_noise_sources_) ns->set_frequencies(w_);
+}
+
+void NoiseMaker::build_source_grid() {
+  const std::size_t n_sources = this->num_noise_sources();
+  if (n_sources == 0) {
+    source_grid_.reset();
+    return;
+  }
+
+  // Boxes of all sources, numbered as in the grid cell lists
+  std::vector<std::array<double, 3>> lows, his;
+  lows.reserve(n_sources);
+  his.reserve(n_sources);
   for (const auto& ns : vibration_noise_sources_) {
-    // Only contribute if we are inside the source region.
-    if (ns->is_inside(p.r())) {
-      dEt_to_return += ns->dEt(p.r(), p.E(), w);
+    lows.push_back({ns->low().x(), ns->low().y(), ns->low().z()});
+    his.push_back({ns->hi().x(), ns->hi().y(), ns->hi().z()});
+  }
+  for (const auto& ns : oscillation_noise_sources_) {
+    lows.push_back({ns->low().x(), ns->low().y(), ns->low().z()});
+    his.push_back({ns->hi().x(), ns->hi().y(), ns->hi().z()});
+  }
+
+  // Get the box containing all sources
+  std::array<double, 3> low = lows.front();
+  std::array<double, 3> hi = his.front();
+  for (std::size_t s = 1; s < n_sources; s++) {
+    for (std::size_t a = 0; a < 3; a++) {
+      low[a] = std::min(low[a], lows[s][a]);
+      hi[a] = std::max(hi[a], his[s][a]);
     }
   }
 
-  for (const auto& ns : oscillation_noise_sources_) {
-    // Only contribute if we are inside the source region.
-    if (ns->is_inside(p.r())) {
-      dEt_to_return += ns->dEt(p.r(), p.E(), w);
+  // The grid cells are taken to be cubes, with about 8 grid cells per source.
+  // There is no use in having a much finer grid, as the sources are
+  // typically of similar sizes, and tile the region they cover.
+  constexpr int32_t MAX_SHAPE = 256;
+  const double volume = (hi[0] - low[0]) * (hi[1] - low[1]) * (hi[2] - low[2]);
+  const double width =
+      std::cbrt(volume / (8. * static_cast<double>(n_sources)));
+
+  auto grid = std::make_shared<SourceGrid>();
+  grid->low = low;
+  for (std::size_t a = 0; a < 3; a++) {
+    const double n = std::ceil((hi[a] - low[a]) / width);
+    grid->shape[a] =
+        static_cast<int32_t>(std::clamp(n, 1., static_cast<double>(MAX_SHAPE)));
+    grid->inv_width[a] = static_cast<double>(grid->shape[a]) / (hi[a] - low[a]);
+  }
+
+  // Range of grid cells overlapped by the box of source s, along axis a
+  auto cell_range = [&grid, &lows, &his](std::size_t s, std::size_t a) {
+    const double inv_w = grid->inv_width[a];
+    const int32_t last = grid->shape[a] - 1;
+    int32_t i_low = static_cast<int32_t>(
+        std::floor((lows[s][a] - grid->low[a]) * inv_w));
+    int32_t i_hi =
+        static_cast<int32_t>(std::floor((his[s][a] - grid->low[a]) * inv_w));
+    return std::make_pair(std::clamp(i_low, 0, last),
+                          std::clamp(i_hi, 0, last));
+  };
+
+  // Calls f(cell) for all grid cells overlapped by the box of source s
+  auto for_each_cell = [&grid, &cell_range](std::size_t s, auto f) {
+    const auto [i_low, i_hi] = cell_range(s, 0);
+    const auto [j_low, j_hi] = cell_range(s, 1);
+    const auto [k_low, k_hi] = cell_range(s, 2);
+    for (int32_t i = i_low; i <= i_hi; i++) {
+      for (int32_t j = j_low; j <= j_hi; j++) {
+        for (int32_t k = k_low; k <= k_hi; k++) {
+          f((static_cast<std::size_t>(i) * grid->shape[1] + j) *
+                grid->shape[2] +
+            k);
+        }
+      }
+    }
+  };
+
+  // Count the sources of each cell, and then fill the lists. Sources are
+  // added in increasing order, so each list ends up sorted.
+  const std::size_t n_cells = static_cast<std::size_t>(grid->shape[0]) *
+                              grid->shape[1] * grid->shape[2];
+  grid->offsets.assign(n_cells + 1, 0);
+  for (std::size_t s = 0; s < n_sources; s++) {
+    for_each_cell(s, [&grid](std::size_t c) { grid->offsets[c + 1]++; });
+  }
+  for (std::size_t c = 0; c < n_cells; c++) {
+    grid->offsets[c + 1] += grid->offsets[c];
+  }
+
+  grid->sources.resize(grid->offsets.back());
+  std::vector<uint32_t> fill(grid->offsets.begin(), grid->offsets.end() - 1);
+  for (std::size_t s = 0; s < n_sources; s++) {
+    for_each_cell(s, [&grid, &fill, s](std::size_t c) {
+      grid->sources[fill[c]++] = static_cast<uint32_t>(s);
+    });
+  }
+
+  source_grid_ = grid;
+}
+
+void NoiseMaker::get_active_sources(const Position& r,
+                                    ActiveSources& active) const {
+  active.vibration.clear();
+  active.oscillation.clear();
+
+  if (!source_grid_) {
+    // No grid yet, so we must check all of the sources
+    for (std::size_t i = 0; i < vibration_noise_sources_.size(); i++) {
+      if (vibration_noise_sources_[i]->is_inside(r)) {
+        active.vibration.push_back(static_cast<uint32_t>(i));
+      }
+    }
+
+    for (std::size_t i = 0; i < oscillation_noise_sources_.size(); i++) {
+      if (oscillation_noise_sources_[i]->is_inside(r)) {
+        active.oscillation.push_back(static_cast<uint32_t>(i));
+      }
+    }
+
+    return;
+  }
+
+  // Find the grid cell, if we are inside the grid at all
+  const SourceGrid& grid = *source_grid_;
+  const std::array<double, 3> x{r.x(), r.y(), r.z()};
+  std::size_t cell = 0;
+  for (std::size_t a = 0; a < 3; a++) {
+    const int32_t i = static_cast<int32_t>(
+        std::floor((x[a] - grid.low[a]) * grid.inv_width[a]));
+    if (i < 0 || i >= grid.shape[a]) return;
+    cell = cell * grid.shape[a] + i;
+  }
+
+  // Only the sources which overlap this cell need to be checked
+  const uint32_t n_vib = static_cast<uint32_t>(vibration_noise_sources_.size());
+  for (uint32_t c = grid.offsets[cell]; c < grid.offsets[cell + 1]; c++) {
+    const uint32_t s = grid.sources[c];
+    if (s < n_vib) {
+      if (vibration_noise_sources_[s]->is_inside(r)) {
+        active.vibration.push_back(s);
+      }
+    } else if (oscillation_noise_sources_[s - n_vib]->is_inside(r)) {
+      active.oscillation.push_back(s - n_vib);
     }
   }
+}
+
+std::complex<double> NoiseMaker::dEt(const Particle& p, MaterialHelper& mat,
+                                     const ActiveSources& active,
+                                     std::size_t freq) const {
+  std::complex<double> dEt_to_return{0., 0.};
+
+  for (const auto& i : active.vibration) {
+    dEt_to_return += vibration_noise_sources_[i]->dEt(p.r(), mat, p.E(), freq);
+  }
+
+  for (const auto& i : active.oscillation) {
+    dEt_to_return +=
+        oscillation_noise_sources_[i]->dEt(p.r(), mat, p.E(), freq);
+  }
 
   return dEt_to_return;
 }
 
 std::complex<double> NoiseMaker::dN(const Position& r, uint32_t nuclide_id,
-                                    double w) const {
+                                    const std::vector<uint32_t>& sources,
+                                    std::size_t freq) const {
   std::complex<double> dN_to_return{0., 0.};
 
-  for (const auto& ns : vibration_noise_sources_) {
-    // Only contribute if we are inside the source region.
-    if (ns->is_inside(r)) {
-      dN_to_return += ns->dN(r, nuclide_id, w);
-    }
+  for (const auto& i : sources) {
+    dN_to_return += vibration_noise_sources_[i]->dN(r, nuclide_id, freq);
   }
 
   return dN_to_return;
 }
 
-bool NoiseMaker::is_inside(const Particle& p) const {
-  // To be inside, it sufices to be inside only one noise source.
-  for (const auto& ns : vibration_noise_sources_) {
-    if (ns->is_inside(p.r())) return true;
+Material* NoiseMaker::get_fake_material(
+    const std::vector<uint32_t>& sources) const {
+  {
+    std::shared_lock lock(fake_materials_->mutex);
+    auto it = fake_materials_->materials.find(sources);
+    if (it != fake_materials_->materials.end()) return it->second.get();
   }
 
-  for (const auto& ns : oscillation_noise_sources_) {
-    if (ns->is_inside(p.r())) return true;
-  }
+  // This combination of sources hasn't been seen yet. Build the material
+  // before locking, as another thread might do the same, in which case only
+  // the first one is kept.
+  std::unique_ptr<Material> fake_mat = make_fake_material(sources);
 
-  return false;
+  std::unique_lock lock(fake_materials_->mutex);
+  auto it =
+      fake_materials_->materials.try_emplace(sources, std::move(fake_mat));
+  return it.first->second.get();
 }
 
 std::unique_ptr<Material> NoiseMaker::make_fake_material(
-    const Particle& p) const {
+    const std::vector<uint32_t>& sources) const {
   std::vector<uint32_t> nuclides_list;
-  std::vector<std::shared_ptr<VibrationNoiseSource>> sources_list;
 
-  // Go through all noise sources
-  for (const auto& ns : vibration_noise_sources_) {
-    // Check if we are inside it
-    if (ns->is_inside(p.r())) {
-      // Save noise source
-      sources_list.push_back(ns);
-
-      // Add these nuclides to the nuclides list
-      std::vector<uint32_t> tmp;
-      std::set_union(nuclides_list.begin(), nuclides_list.end(),
-                     ns->nuclides().begin(), ns->nuclides().end(),
-                     std::back_inserter(tmp));
-      nuclides_list = tmp;
-    }
+  // Go through all noise sources which we are inside of
+  for (const auto& i : sources) {
+    const auto& ns = vibration_noise_sources_[i];
+
+    // Add these nuclides to the nuclides list
+    std::vector<uint32_t> tmp;
+    std::set_union(nuclides_list.begin(), nuclides_list.end(),
+                   ns->nuclides().begin(), ns->nuclides().end(),
+                   std::back_inserter(tmp));
+    nuclides_list = tmp;
   }
 
   // nuclides_list should now contain all of the nuclides which are
@@ -130,12 +283,15 @@ std::unique_ptr<Material> NoiseMaker::make_fake_material(
   // for each of them in the fake material now.
   std::vector<double> concentrations(nuclides_list.size(), 0.);
 
-  const double num_sources = static_cast<double>(sources_list.size());
+  const double num_sources = static_cast<double>(sources.size());
   for (std::size_t i = 0; i < nuclides_list.size(); i++) {
     const uint32_t nuclide_id = nuclides_list[i];
     double conc_sum = 0.;
-    for (const auto& ns : sources_list) {
-      conc_sum += ns->nuclide_info().at(nuclide_id).concentration;
+    for (const auto& j : sources) {
+      conc_sum += vibration_noise_sources_[j]
+                      ->nuclide_info()
+                      .at(nuclide_id)
+                      .concentration;
     }
     concentrations[i] = conc_sum / num_sources;
   }
@@ -153,37 +309,49 @@ std::unique_ptr<Material> NoiseMaker::make_fake_material(
 }
 
 void NoiseMaker::sample_noise_copy(Particle& p, MaterialHelper& mat,
-                                   const double w) const {
-  const std::complex<double> dEt_Et = this->dEt(p, w) / mat.Et(p.E());
-
-  std::complex<double> weight_copy{p.wgt(), p.wgt2()};
-
-  // Negative needed for source sampling
-  weight_copy *= -dEt_Et;
-
-  // Create and return the neutron
-  BankedParticle p_noise{p.r(),
-                         p.u(),
-                         p.E(),
-                         weight_copy.real(),
-                         weight_copy.imag(),
-                         p.history_id(),
-                         p.daughter_counter(),
-                         p.family_id(),
-                         p.previous_collision_virtual(),
-                         p.previous_r(),
-                         p.previous_u(),
-                         p.previous_E(),
-                         p.E(),
-                         p.Esmp()};
+                                   const ActiveSources& active) const {
+  const double Et = mat.Et(p.E());
+
+  for (std::size_t freq = 0; freq < w_.size(); freq++) {
+    const std::complex<double> dEt_Et = this->dEt(p, mat, active, freq) / Et;
+
+    std::complex<double> weight_copy{p.wgt(), p.wgt2()};
+
+    // Negative needed for source sampling
+    weight_copy *= -dEt_Et;
+
+    // Create and return the neutron
+    BankedParticle p_noise{p.r(),
+                           p.u(),
+                           p.E(),
+                           weight_copy.real(),
+                           weight_copy.imag(),
+                           p.history_id(),
+                           p.daughter_counter(),
+                           p.family_id(),
+                           p.previous_collision_virtual(),
+                           p.previous_r(),
+                           p.previous_u(),
+                           p.previous_E(),
+                           p.E(),
+                           p.Esmp()};
+    p_noise.noise_frequency = static_cast<uint32_t>(freq);
+
+    p.add_noise_particle(p_noise);
+  }
+}
 
-  p.add_noise_particle(p_noise);
+std::complex<double> NoiseMaker::delayed_multiplier(double lambda,
+                                                    std::size_t freq) const {
+  const double w = w_[freq];
+  double denom = (lambda * lambda) + (w * w);
+  return {lambda * lambda / denom, -lambda * w / denom};
 }
 
 void NoiseMaker::sample_vibration_noise_fission(
     Particle& p, const Nuclide& nuclide, const MicroXSs& microxs,
-    const std::complex<double>& dN_N, const double Etfake_Et, const double keff,
-    const double w) const {
+    const std::vector<std::complex<double>>& dN_N, const double Etfake_Et,
+    const double keff) const {
   // First, check if the nuclide is fissile. If it isn't, we
   // just return.
   if (nuclide.fissile() == false) return;
@@ -200,57 +368,15 @@ void NoiseMaker::sample_vibration_noise_fission(
     auto finfo = nuclide.sample_fission(p.E(), p.u(), microxs.energy_index,
                                         P_delayed, p.rng);
 
-    // Sample a banked noise particle from fission.
-    BankedParticle bnp{p.r(),
-                       finfo.direction,
-                       finfo.energy,
-                       p.wgt(),
-                       p.wgt2(),
-                       p.history_id(),
-                       p.daughter_counter(),
-                       p.family_id(),
-                       p.previous_collision_virtual(),
-                       p.previous_r(),
-                       p.previous_u(),
-                       p.previous_E(),
-                       p.E(),
-                       p.Esmp()};
-
-    if (finfo.delayed) {
-      std::complex<double> wgt_cmpx{bnp.wgt, bnp.wgt2};
-      double lambda = finfo.precursor_decay_constant;
-      double denom = (lambda * lambda) + (w * w);
-      std::complex<double> mult{lambda * lambda / denom, -lambda * w / denom};
-      wgt_cmpx *= mult;
-      bnp.wgt = wgt_cmpx.real();
-      bnp.wgt2 = wgt_cmpx.imag();
-    }
-
-    // Apply the weight corrections
-    std::complex<double> bnp_wgt{bnp.wgt, bnp.wgt2};
-    bnp_wgt *= dN_N;
-    bnp_wgt *= Etfake_Et;
-    bnp.wgt = bnp_wgt.real();
-    bnp.wgt2 = bnp_wgt.imag();
-
-    // Save the noise particle
-    p.add_noise_particle(bnp);
-  }
-}
-
-void NoiseMaker::sample_vibration_noise_scatter(
-    Particle& p, const Nuclide& nuclide, const MicroXSs& microxs,
-    const std::complex<double>& dN_N, const double Etfake_Et,
-    const double P_scatter) const {
-  // First, sample the scatter info from the nuclide
-  ScatterInfo sinfo = nuclide.sample_scatter(p.E(), p.u(), microxs, p.rng);
-
-  // Make the noise particle without weights
-  BankedParticle p_noise{p.r(),
-                         sinfo.direction,
-                         sinfo.energy,
-                         0.,  // wgt
-                         0.,  // wgt2
+    // The same fission neutron is used for all frequencies. Only its weight
+    // depends on the frequency.
+    for (std::size_t freq = 0; freq < w_.size(); freq++) {
+      // Sample a banked noise particle from fission.
+      BankedParticle bnp{p.r(),
+                         finfo.direction,
+                         finfo.energy,
+                         p.wgt(),
+                         p.wgt2(),
                          p.history_id(),
                          p.daughter_counter(),
                          p.family_id(),
@@ -260,130 +386,164 @@ void NoiseMaker::sample_vibration_noise_scatter(
                          p.previous_E(),
                          p.E(),
                          p.Esmp()};
+      bnp.noise_frequency = static_cast<uint32_t>(freq);
+
+      // Apply the weight corrections
+      std::complex<double> bnp_wgt{bnp.wgt, bnp.wgt2};
+      if (finfo.delayed) {
+        bnp_wgt *= delayed_multiplier(finfo.precursor_decay_constant, freq);
+      }
+      bnp_wgt *= dN_N[freq];
+      bnp_wgt *= Etfake_Et;
+      bnp.wgt = bnp_wgt.real();
+      bnp.wgt2 = bnp_wgt.imag();
 
-  std::complex<double> wgt{p.wgt(), p.wgt2()};
-  wgt *= sinfo.yield;       // Multiply by scattering yield
-  wgt *= P_scatter;         // Implicit capture
-  wgt *= dN_N * Etfake_Et;  // Weight corrections for noise
+      // Save the noise particle
+      p.add_noise_particle(bnp);
+    }
+  }
+}
 
-  // Set the weight
-  p_noise.wgt = wgt.real();
-  p_noise.wgt2 = wgt.imag();
+void NoiseMaker::sample_vibration_noise_scatter(
+    Particle& p, const Nuclide& nuclide, const MicroXSs& microxs,
+    const std::vector<std::complex<double>>& dN_N, const double Etfake_Et,
+    const double P_scatter) const {
+  // First, sample the scatter info from the nuclide
+  ScatterInfo sinfo = nuclide.sample_scatter(p.E(), p.u(), microxs, p.rng);
 
-  // Save noise particle
-  p.add_noise_particle(p_noise);
+  for (std::size_t freq = 0; freq < w_.size(); freq++) {
+    // Make the noise particle without weights
+    BankedParticle p_noise{p.r(),
+                           sinfo.direction,
+                           sinfo.energy,
+                           0.,  // wgt
+                           0.,  // wgt2
+                           p.history_id(),
+                           p.daughter_counter(),
+                           p.family_id(),
+                           p.previous_collision_virtual(),
+                           p.previous_r(),
+                           p.previous_u(),
+                           p.previous_E(),
+                           p.E(),
+                           p.Esmp()};
+    p_noise.noise_frequency = static_cast<uint32_t>(freq);
+
+    std::complex<double> wgt{p.wgt(), p.wgt2()};
+    wgt *= sinfo.yield;             // Multiply by scattering yield
+    wgt *= P_scatter;               // Implicit capture
+    wgt *= dN_N[freq] * Etfake_Et;  // Weight corrections for noise
+
+    // Set the weight
+    p_noise.wgt = wgt.real();
+    p_noise.wgt2 = wgt.imag();
+
+    // Save noise particle
+    p.add_noise_particle(p_noise);
+  }
 }
 
 void NoiseMaker::sample_noise_source(Particle& p, MaterialHelper& mat,
-                                     const double keff, const double w) const {
-  // First, check if we are inside any noise source. If no, we can return
-  // without making any noise particles.
-  if (this->is_inside(p) == false) return;
+                                     const double keff) const {
+  // First, find all noise sources we are inside of. If there are none, we can
+  // return without making any noise particles. The lists are kept for each
+  // thread, so that they need not be reallocated.
+  thread_local ActiveSources active;
+  this->get_active_sources(p.r(), active);
+  if (active.empty()) return;
 
   // First, we can go ahead and make the copy, as it's easiest to do.
-  this->sample_noise_copy(p, mat, w);
+  this->sample_noise_copy(p, mat, active);
 
   // Now from this point on, we sample the oscillation and vibration
   // parts separately
-  this->sample_vibration_noise_source(p, mat, keff, w);
-
-  this->sample_oscillation_noise_source(p, mat, keff, w);
-}
-
-void NoiseMaker::sample_oscillation_noise_source(Particle& p,
-                                                 MaterialHelper& mat,
-                                                 const double keff,
-                                                 const double w) const {
-  // First, check if we are inside any oscillation noise source.
-  // If no, we can return without making any noise particles.
-  bool inside_oscillation_source = false;
-  for (const auto& ns : oscillation_noise_sources_) {
-    if (ns->is_inside(p.r())) {
-      inside_oscillation_source = true;
-      break;
-    }
+  if (!active.vibration.empty()) {
+    this->sample_vibration_noise_source(p, mat, active.vibration, keff);
   }
-  if (inside_oscillation_source == false) {
-    return;
+
+  if (!active.oscillation.empty()) {
+    this->sample_oscillation_noise_source(p, mat, active.oscillation, keff);
   }
+}
 
+void NoiseMaker::sample_oscillation_noise_source(
+    Particle& p, MaterialHelper& mat, const std::vector<uint32_t>& sources,
+    const double keff) const {
   // We now sample a nuclide for sampling the source particles.
   auto nuclide_data = mat.sample_nuclide(p.E(), p.rng);
   const Nuclide* nuclide = nuclide_data.first;
   const MicroXSs& microxs = nuclide_data.second;
 
-  this->sample_oscillation_noise_fission(p, *nuclide, microxs, keff, w);
+  this->sample_oscillation_noise_fission(p, *nuclide, microxs, sources, keff);
 
   // Now we calculate the scatter probability to modify the weight
   // of the scatter noise source. This is the "implicit capture" correciton,
   // needed because we forced the sampling of the fission noise source.
   const double P_scatter = 1. - (microxs.absorption / microxs.total);
 
-  this->sample_oscillation_noise_scatter(p, *nuclide, microxs, P_scatter, w);
+  this->sample_oscillation_noise_scatter(p, *nuclide, microxs, sources,
+                                         P_scatter);
 }
 
-void NoiseMaker::sample_oscillation_noise_scatter(Particle& p,
-                                                  const Nuclide& nuclide,
-                                                  const MicroXSs& microxs,
-                                                  const double P_scatter,
-                                                  const double w) const {
+void NoiseMaker::sample_oscillation_noise_scatter(
+    Particle& p, const Nuclide& nuclide, const MicroXSs& microxs,
+    const std::vector<uint32_t>& sources, const double P_scatter) const {
   // First, sample the scatter info from the nuclide
   ScatterInfo sinfo = nuclide.sample_scatter(p.E(), p.u(), microxs, p.rng);
 
-  // Make the noise particle without weights
-  BankedParticle p_noise{p.r(),
-                         sinfo.direction,
-                         sinfo.energy,
-                         0.,  // wgt
-                         0.,  // wgt2
-                         p.history_id(),
-                         p.daughter_counter(),
-                         p.family_id(),
-                         p.previous_collision_virtual(),
-                         p.previous_r(),
-                         p.previous_u(),
-                         p.previous_E(),
-                         p.E(),
-                         p.Esmp()};
-
-  std::complex<double> wgt{p.wgt(), p.wgt2()};
-  wgt *= sinfo.yield;  // Multiply by scattering yield
-  wgt *= P_scatter;    // Implicit capture
-
-  // Get the complex weight factor
-  std::complex<double> dE_E{0., 0.};
-  if (sinfo.mt == 2) {
-    // Go through and get all elastic scatter stuff
-    for (const auto& ns : oscillation_noise_sources_) {
-      if (ns->is_inside(p.r())) {
-        dE_E += ns->dEelastic_Eelastic(p.r(), p.E(), w);
+  for (std::size_t freq = 0; freq < w_.size(); freq++) {
+    // Make the noise particle without weights
+    BankedParticle p_noise{p.r(),
+                           sinfo.direction,
+                           sinfo.energy,
+                           0.,  // wgt
+                           0.,  // wgt2
+                           p.history_id(),
+                           p.daughter_counter(),
+                           p.family_id(),
+                           p.previous_collision_virtual(),
+                           p.previous_r(),
+                           p.previous_u(),
+                           p.previous_E(),
+                           p.E(),
+                           p.Esmp()};
+    p_noise.noise_frequency = static_cast<uint32_t>(freq);
+
+    std::complex<double> wgt{p.wgt(), p.wgt2()};
+    wgt *= sinfo.yield;  // Multiply by scattering yield
+    wgt *= P_scatter;    // Implicit capture
+
+    // Get the complex weight factor
+    std::complex<double> dE_E{0., 0.};
+    if (sinfo.mt == 2) {
+      // Go through and get all elastic scatter stuff
+      for (const auto& i : sources) {
+        dE_E += oscillation_noise_sources_[i]->dEelastic_Eelastic(p.r(), p.E(),
+                                                                 freq);
       }
-    }
-  } else {
-    // Go through and get MT info
-    // ONLY POSSIBLE IN CE MODE
-    for (const auto& ns : oscillation_noise_sources_) {
-      if (ns->is_inside(p.r())) {
-        dE_E += ns->dEmt_Emt(sinfo.mt, p.r(), p.E(), w);
+    } else {
+      // Go through and get MT info
+      // ONLY POSSIBLE IN CE MODE
+      for (const auto& i : sources) {
+        dE_E += oscillation_noise_sources_[i]->dEmt_Emt(sinfo.mt, p.r(),
+                                                       p.E(), freq);
       }
     }
-  }
 
-  wgt *= dE_E;
+    wgt *= dE_E;
 
-  // Set the weight
-  p_noise.wgt = wgt.real();
-  p_noise.wgt2 = wgt.imag();
+    // Set the weight
+    p_noise.wgt = wgt.real();
+    p_noise.wgt2 = wgt.imag();
 
-  // Save noise particle
-  p.add_noise_particle(p_noise);
+    // Save noise particle
+    p.add_noise_particle(p_noise);
+  }
 }
 
-void NoiseMaker::sample_oscillation_noise_fission(Particle& p,
-                                                  const Nuclide& nuclide,
-                                                  const MicroXSs& microxs,
-                                                  const double keff,
-                                                  const double w) const {
+void NoiseMaker::sample_oscillation_noise_fission(
+    Particle& p, const Nuclide& nuclide, const MicroXSs& microxs,
+    const std::vector<uint32_t>& sources, const double keff) const {
   // First, check if the nuclide is fissile. If it isn't, we
   // just return.
   if (nuclide.fissile() == false) return;
@@ -392,103 +552,102 @@ void NoiseMaker::sample_oscillation_noise_fission(Particle& p,
   const double k_abs = microxs.nu_total * microxs.fission / microxs.total;
   const int n_new =
       static_cast<int>(std::floor(k_abs / keff + RNG::rand(p.rng)));
+  if (n_new == 0) return;
 
   // Calculate the probability of a delayed neutron
   const double P_delayed = microxs.nu_delayed / microxs.nu_total;
 
-  // Get the weight modifier
-  std::complex<double> dEf_Ef = {0., 0.};
-  for (const auto& ns : oscillation_noise_sources_) {
-    if (ns->is_inside(p.r())) {
-      dEf_Ef += ns->dEf_Ef(p.r(), p.E(), w);
+  // Get the weight modifier for each frequency. The modifiers are kept for
+  // each thread, so that they need not be reallocated.
+  thread_local std::vector<std::complex<double>> dEf_Ef;
+  dEf_Ef.assign(w_.size(), {0., 0.});
+  for (std::size_t freq = 0; freq < w_.size(); freq++) {
+    for (const auto& i : sources) {
+      dEf_Ef[freq] += oscillation_noise_sources_[i]->dEf_Ef(p.r(), p.E(), freq);
     }
   }
 
-  for (int i = 0; i < n_new; i++) {
+  for (int n = 0; n < n_new; n++) {
     auto finfo = nuclide.sample_fission(p.E(), p.u(), microxs.energy_index,
                                         P_delayed, p.rng);
 
-    BankedParticle bnp{p.r(),
-                       finfo.direction,
-                       finfo.energy,
-                       p.wgt(),
-                       p.wgt2(),
-                       p.history_id(),
-                       p.daughter_counter(),
-                       p.family_id(),
-                       p.previous_collision_virtual(),
-                       p.previous_r(),
-                       p.previous_u(),
-                       p.previous_E(),
-                       p.E(),
-                       p.Esmp()};
-
-    if (finfo.delayed) {
-      std::complex<double> wgt_cmpx{bnp.wgt, bnp.wgt2};
-      double lambda = finfo.precursor_decay_constant;
-      double denom = (lambda * lambda) + (w * w);
-      std::complex<double> mult{lambda * lambda / denom, -lambda * w / denom};
-      wgt_cmpx *= mult;
-      bnp.wgt = wgt_cmpx.real();
-      bnp.wgt2 = wgt_cmpx.imag();
-    }
-
-    // Modify weight
-    std::complex<double> fnp_weight{bnp.wgt, bnp.wgt2};
-    fnp_weight *= dEf_Ef;
-    bnp.wgt = fnp_weight.real();
-    bnp.wgt2 = fnp_weight.imag();
+    // The same fission neutron is used for all frequencies. Only its weight
+    // depends on the frequency.
+    for (std::size_t freq = 0; freq < w_.size(); freq++) {
+      BankedParticle bnp{p.r(),
+                         finfo.direction,
+                         finfo.energy,
+                         p.wgt(),
+                         p.wgt2(),
+                         p.history_id(),
+                         p.daughter_counter(),
+                         p.family_id(),
+                         p.previous_collision_virtual(),
+                         p.previous_r(),
+                         p.previous_u(),
+                         p.previous_E(),
+                         p.E(),
+                         p.Esmp()};
+      bnp.noise_frequency = static_cast<uint32_t>(freq);
 
-    // Save BankedParticle
-    p.add_noise_particle(bnp);
-  }
-}
+      // Modify weight
+      std::complex<double> fnp_weight{bnp.wgt, bnp.wgt2};
+      if (finfo.delayed) {
+        fnp_weight *= delayed_multiplier(finfo.precursor_decay_constant, freq);
+      }
+      fnp_weight *= dEf_Ef[freq];
+      bnp.wgt = fnp_weight.real();
+      bnp.wgt2 = fnp_weight.imag();
 
-void NoiseMaker::sample_vibration_noise_source(Particle& p, MaterialHelper& mat,
-                                               const double keff,
-                                               const double w) const {
-  // First, check if we are inside any vibration noise source.
-  // If no, we can return without making any noise particles.
-  bool inside_vibration_source = false;
-  for (const auto& ns : vibration_noise_sources_) {
-    if (ns->is_inside(p.r())) {
-      inside_vibration_source = true;
-      break;
+      // Save BankedParticle
+      p.add_noise_particle(bnp);
     }
   }
-  if (inside_vibration_source == false) {
-    return;
-  }
+}
 
-  // Now, we need to get our ficticious material, which represents a
+void NoiseMaker::sample_vibration_noise_source(
+    Particle& p, MaterialHelper& mat, const std::vector<uint32_t>& sources,
+    const double keff) const {
+  // We need to get our ficticious material, which represents a
   // sort of homogenization of all materials involved in all of the
-  // noise regions where the particle is currently located.
-  std::unique_ptr<Material> fake_material = make_fake_material(p);
-  MaterialHelper fake_mat(fake_material.get(), p.E());
-
-  // We now grab the URR data from the original material, and use it in the
-  // fake material.
-  fake_mat.set_urr_rand_vals(mat.urr_rand_vals());
+  // noise regions where the particle is currently located. The cross
+  // sections are evaluated with the helper of the actual material, so that
+  // the micro xs already computed at this energy, and the URR random
+  // values, are shared between the two materials.
+  const double Et = mat.Et(p.E());
+  Material* material = mat.material();
+  mat.set_material(this->get_fake_material(sources), p.E());
 
   // We now sample a nuclide from this fake material.
-  auto nuclide_data = fake_mat.sample_nuclide(p.E(), p.rng);
+  auto nuclide_data = mat.sample_nuclide(p.E(), p.rng);
   const Nuclide* nuclide = nuclide_data.first;
-  const MicroXSs& microxs = nuclide_data.second;
+  const MicroXSs microxs = nuclide_data.second;
+  const double Etfake = mat.Et(p.E());
+
+  // Go back to the real material
+  mat.set_material(material, p.E());
+
   // Id of sampled nuclide
   const uint32_t nuclide_id = nuclide->id();
   // Concentration of sampled nuclide in fake material
   const double N = microxs.concentration;
 
-  // Ratio of dN / N, to be used as part of the weight modifier.
-  const std::complex<double> dN_N = this->dN(p.r(), nuclide_id, w) / N;
+  // Ratio of dN / N for each frequency, to be used as part of the weight
+  // modifier. The ratios are kept for each thread, so that they need not be
+  // reallocated.
+  thread_local std::vector<std::complex<double>> dN_N;
+  dN_N.resize(w_.size());
+  for (std::size_t freq = 0; freq < w_.size(); freq++) {
+    dN_N[freq] = this->dN(p.r(), nuclide_id, sources, freq) / N;
+  }
 
   // Ratio of Et in the fake material, to Et in the actual material.
   // This will also be used as a weight modifier.
-  const double Etfake_Et = fake_mat.Et(p.E()) / mat.Et(p.E());
+  const double Etfake_Et = Etfake / Et;
 
   // Sample the fission noise source particles
   this->sample_vibration_noise_fission(p, *nuclide, microxs, dN_N, Etfake_Et,
-                                       keff, w);
+                                       keff);
 
   // Now we calculate the scatter probability to modify the weight
   // of the scatter noise source. This is the "implicit capture" correciton,
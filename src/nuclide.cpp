@@ -27,5 +27,5 @@
 #include <cstdint>
 
 std::map<uint32_t, std::shared_ptr<Nuclide>> nuclides;
-std::unordered_set<uint32_t> zaids_with_urr;
+std::unordered_map<uint32_t, std::size_t> urr_slots;
 uint32_t Nuclide::id_counter{0};
@@ -28,10 +28,13 @@
 #include <utils/output.hpp>
 #include <utils/settings.hpp>
 
+#include <algorithm>
+#include <exception>
 #include <filesystem>
 #include <iostream>
 #include <source_location>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 
 #ifdef ABEILLE_USE_OMP
@@ -79,6 +82,17 @@ Output::Output() : output(std::nullopt), warnings_for_latter() {
   }
 }
 
+Output::~Output() {
+  if (writer.joinable()) {
+    {
+      std::unique_lock lock(queue_mutex);
+      stop_writer = true;
+    }
+    queue_cv.notify_all();
+    writer.join();
+  }
+}
+
 void Output::set_output_filename(const std::string& fname) {
   output_filename = fname;
 }
@@ -125,11 +139,128 @@ H5::File& Output::h5(const std::source_location& loc) {
     fatal_error("Only master can write to output file.", loc);
   }
 
+  wait_for_writes();
+
   return *output;
 }
 
+void Output::write_async(std::function<void(H5::File&)> job,
+                         std::size_t nbytes) {
+  if (mpi::rank != 0 || !output) return;
+
+  const std::size_t max_bytes =
+      static_cast<std::size_t>(settings::stream_queue_size) * 1024 * 1024;
+
+  std::unique_lock lock(queue_mutex);
+  if (!writer.joinable()) writer = std::thread(&Output::writer_loop, this);
+
+  // Wait for room in the queue. A job larger than the queue is still
+  // accepted once the queue is empty.
+  queue_cv.wait(lock, [this, nbytes, max_bytes] {
+    return write_queue.empty() || queued_bytes + nbytes <= max_bytes ||
+           !writer_error.empty();
+  });
+
+  if (!writer_error.empty()) {
+    std::string mssg = writer_error;
+    lock.unlock();
+    fatal_error("Background write to output file failed: " + mssg);
+  }
+
+  write_queue.push_back({std::move(job), nbytes});
+  queued_bytes += nbytes;
+  lock.unlock();
+  queue_cv.notify_all();
+}
+
+void Output::wait_for_writes() {
+  std::unique_lock lock(queue_mutex);
+  queue_cv.wait(lock, [this] {
+    return (write_queue.empty() && !writing) || !writer_error.empty();
+  });
+
+  if (!writer_error.empty()) {
+    std::string mssg = writer_error;
+    writer_error.clear();
+    lock.unlock();
+    fatal_error("Background write to output file failed: " + mssg);
+  }
+}
+
+void Output::writer_loop() {
+  std::unique_lock lock(queue_mutex);
+  while (true) {
+    queue_cv.wait(lock, [this] { return stop_writer || !write_queue.empty(); });
+    if (write_queue.empty()) return;
+
+    WriteJob job = std::move(write_queue.front());
+    write_queue.pop_front();
+    writing = true;
+    lock.unlock();
+
+    // Only this thread touches the HDF5 library while a job is running, as
+    // the main thread waits for the queue to be empty before using it.
+    std::string error;
+    try {
+      job.job(*output);
+    } catch (const std::exception& err) {
+      error = err.what();
+    }
+
+    lock.lock();
+    writing = false;
+    queued_bytes -= job.nbytes;
+    if (!error.empty() && writer_error.empty()) writer_error = error;
+    queue_cv.notify_all();
+  }
+}
+
 //============================================================================
 // Non-Member Functions
+void append_row(H5::File& h5, const std::string& name,
+                const std::vector<double>& row,
+                const std::vector<std::size_t>& row_shape) {
+  std::vector<std::size_t> dims{0};
+  dims.insert(dims.end(), row_shape.begin(), row_shape.end());
+
+  if (!h5.exist(name)) {
+    // Chunks hold about 1 MB. Small rows are grouped into chunks of many
+    // rows, so that they are not written one at a time, while large rows
+    // are split over many chunks, starting with their last axes. HDF5 does
+    // not allow chunks larger than 4 GB, which a row of a large mesh tally
+    // would exceed.
+    std::vector<hsize_t> chunk(dims.size(), 1);
+    std::size_t budget = (1024 * 1024) / sizeof(double);
+    for (std::size_t d = row_shape.size(); d-- > 0;) {
+      chunk[d + 1] = std::max<std::size_t>(1, std::min(row_shape[d], budget));
+      budget = std::max<std::size_t>(1, budget / chunk[d + 1]);
+    }
+    chunk[0] = budget;
+
+    std::vector<std::size_t> max_dims = dims;
+    max_dims[0] = H5::DataSpace::UNLIMITED;
+
+    H5::DataSetCreateProps props;
+    props.add(H5::Chunking(chunk));
+    h5.createDataSet<double>(name, H5::DataSpace(dims, max_dims), props);
+  }
+
+  auto dset = h5.getDataSet(name);
+  std::vector<std::size_t> old_dims = dset.getDimensions();
+  if (old_dims.size() != dims.size()) {
+    throw std::runtime_error("Row of invalid shape appended to " + name);
+  }
+  dims = old_dims;
+  dims[0]++;
+  dset.resize(dims);
+
+  std::vector<std::size_t> offset(dims.size(), 0);
+  offset[0] = old_dims[0];
+  std::vector<std::size_t> count = dims;
+  count[0] = 1;
+  dset.select(offset, count).write_raw(row.data());
+}
+
 void print_header() {
   Output& output = Output::instance();
   output.write(logo);
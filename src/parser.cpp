@@ -69,6 +69,7 @@ std::map<uint32_t, size_t> universe_id_to_indx;
 std::vector<std::shared_ptr<Source>> sources;
 NoiseMaker noise_maker;
 std::shared_ptr<Tallies> tallies = nullptr;
+std::vector<std::shared_ptr<Tallies>> frequency_tallies;
 std::shared_ptr<Transporter> transporter = nullptr;
 std::shared_ptr<Simulation> simulation = nullptr;
 std::shared_ptr<Cancelator> cancelator = nullptr;
@@ -222,13 +223,6 @@ void make_geometry(const YAML::Node& input) {
     }
   }
 
-  // Now that all surfaces, cells, and universes have been created, we can go
-  // through and create all of the offset maps for determining the unique
-  // instance of each material cell.
-  for (auto& uni : geometry::universes) {
-    uni->make_offset_map();
-  }
-
   // Parse root universe
   if (input["root-universe"] && input["root-universe"].IsScalar()) {
     uint32_t root_id = input["root-universe"].as<uint32_t>();
@@ -243,6 +237,29 @@ void make_geometry(const YAML::Node& input) {
     // If doesn't exist and isn't a scalar, kill program
     fatal_error("No root-universe is provided in input file.");
   }
+
+  // Remove unnecessary levels from the geometry tree, so that the Tracker has
+  // fewer levels to go through.
+  if (settings::flatten_geometry) {
+    const uint32_t depth = geometry::root_universe->depth();
+
+    for (auto& uni : geometry::universes) {
+      uni->flatten();
+    }
+
+    std::stringstream mssg;
+    mssg << " Geometry depth before flattening : " << depth << "\n";
+    mssg << " Geometry depth after flattening  : "
+         << geometry::root_universe->depth() << "\n";
+    Output::instance().write(mssg.str());
+  }
+
+  // Now that all surfaces, cells, and universes have been created, we can go
+  // through and create all of the offset maps for determining the unique
+  // instance of each material cell.
+  for (auto& uni : geometry::universes) {
+    uni->make_offset_map();
+  }
 }
 
 void make_surface(const YAML::Node& surface_node) {
@@ -714,18 +731,28 @@ void make_settings(const YAML::Node& input) {
 
     // Get the frequency and keff for noise simulations
     if (settings::mode == settings::SimulationMode::NOISE) {
-      // Frequency
-      if (!settnode["noise-angular-frequency"] ||
-          !settnode["noise-angular-frequency"].IsScalar()) {
+      // Frequency, or list of frequencies which are all simulated with the
+      // same power iteration generations.
+      if (settnode["noise-angular-frequency"] &&
+          settnode["noise-angular-frequency"].IsScalar()) {
+        settings::noise_frequencies = {
+            settnode["noise-angular-frequency"].as<double>()};
+      } else if (settnode["noise-angular-frequency"] &&
+                 settnode["noise-angular-frequency"].IsSequence() &&
+                 settnode["noise-angular-frequency"].size() > 0) {
+        settings::noise_frequencies =
+            settnode["noise-angular-frequency"].as<std::vector<double>>();
+      } else {
         fatal_error(
             "No valid noise-angular-frequency in settings for noise "
             "simulation.");
       }
-      settings::w_noise = settnode["noise-angular-frequency"].as<double>();
+      settings::w_noise = settings::noise_frequencies.front();
 
-      Output::instance().write(
-          " Noise angular-frequency: " + std::to_string(settings::w_noise) +
-          " radians / s.\n");
+      for (const auto& w : settings::noise_frequencies) {
+        Output::instance().write(" Noise angular-frequency: " +
+                                 std::to_string(w) + " radians / s.\n");
+      }
 
       // Keff
       if (!settnode["keff"] || !settnode["keff"].IsScalar()) {
@@ -773,6 +800,14 @@ void make_settings(const YAML::Node& input) {
           "Invalid \"rng-stride-warnings\" entry provided in settings.");
     }
 
+    // See if the user wants the geometry to be flattened
+    if (settnode["flatten-geometry"] &&
+        settnode["flatten-geometry"].IsScalar()) {
+      settings::flatten_geometry = settnode["flatten-geometry"].as<bool>();
+    } else if (settnode["flatten-geometry"]) {
+      fatal_error("Invalid \"flatten-geometry\" entry provided in settings.");
+    }
+
     // Get name of source in file
     if (settnode["insource"] && settnode["insource"].IsScalar()) {
       settings::in_source_file_name = settnode["insource"].as<std::string>();
@@ -788,6 +823,115 @@ void make_settings(const YAML::Node& input) {
       }
     }
 
+    // Get the layout of the written source
+    if (settnode["source-float32"] && settnode["source-float32"].IsScalar()) {
+      settings::source_float32 = settnode["source-float32"].as<bool>();
+    } else if (settnode["source-float32"]) {
+      fatal_error(
+          "The settings option \"source-float32\" must be a single boolean "
+          "value.");
+    }
+
+    if (settnode["source-compression"] &&
+        settnode["source-compression"].IsScalar()) {
+      settings::source_compression = settnode["source-compression"].as<int>();
+      if (settings::source_compression < 0 ||
+          settings::source_compression > 9) {
+        fatal_error(
+            "The settings option \"source-compression\" must be an integer "
+            "from 0 to 9.");
+      }
+    } else if (settnode["source-compression"]) {
+      fatal_error(
+          "The settings option \"source-compression\" must be an integer "
+          "from 0 to 9.");
+    }
+
+    // Get the checkpoint options
+    if (settnode["checkpoint-interval"] &&
+        settnode["checkpoint-interval"].IsScalar()) {
+      settings::checkpoint_interval =
+          settnode["checkpoint-interval"].as<int>();
+      if (settings::checkpoint_interval < 0) {
+        fatal_error(
+            "The settings option \"checkpoint-interval\" must be a "
+            "non-negative integer.");
+      }
+    } else if (settnode["checkpoint-interval"]) {
+      fatal_error(
+          "The settings option \"checkpoint-interval\" must be a "
+          "non-negative integer.");
+    }
+
+    if (settnode["checkpoint-file"] && settnode["checkpoint-file"].IsScalar()) {
+      settings::checkpoint_file_name =
+          settnode["checkpoint-file"].as<std::string>();
+    } else if (settnode["checkpoint-file"]) {
+      fatal_error(
+          "The settings option \"checkpoint-file\" must be a single file "
+          "name.");
+    }
+
+    // Get the streaming options
+    if (settnode["stream-generations"] &&
+        settnode["stream-generations"].IsScalar()) {
+      settings::stream_generations =
+          settnode["stream-generations"].as<bool>();
+    } else if (settnode["stream-generations"]) {
+      fatal_error(
+          "The settings option \"stream-generations\" must be a boolean.");
+    }
+
+    if (settnode["stream-queue-size"] &&
+        settnode["stream-queue-size"].IsScalar()) {
+      settings::stream_queue_size = settnode["stream-queue-size"].as<int>();
+      if (settings::stream_queue_size < 1) {
+        fatal_error(
+            "The settings option \"stream-queue-size\" must be a positive "
+            "integer.");
+      }
+    } else if (settnode["stream-queue-size"]) {
+      fatal_error(
+          "The settings option \"stream-queue-size\" must be a positive "
+          "integer.");
+    }
+
+    // Get the number of generations in each mesh tally batch
+    if (settnode["tally-batch-size"] &&
+        settnode["tally-batch-size"].IsScalar()) {
+      settings::tally_batch_size = settnode["tally-batch-size"].as<int>();
+      if (settings::tally_batch_size < 1) {
+        fatal_error(
+            "The settings option \"tally-batch-size\" must be a positive "
+            "integer.");
+      }
+    } else if (settnode["tally-batch-size"]) {
+      fatal_error(
+          "The settings option \"tally-batch-size\" must be a positive "
+          "integer.");
+    }
+
+    // Get the number of tally servers
+    if (settnode["tally-servers"] && settnode["tally-servers"].IsScalar()) {
+      settings::tally_servers = settnode["tally-servers"].as<int>();
+      if (settings::tally_servers < 0) {
+        fatal_error(
+            "The settings option \"tally-servers\" must be a non-negative "
+            "integer.");
+      } else if (settings::tally_servers >= mpi::size) {
+        fatal_error(
+            "The number of tally servers must be less than the number of MPI "
+            "ranks.");
+      } else if (settings::tally_servers > 0 &&
+                 (settings::restart || settings::checkpoint_interval > 0)) {
+        fatal_error("Checkpoints cannot be used with tally servers.");
+      }
+    } else if (settnode["tally-servers"]) {
+      fatal_error(
+          "The settings option \"tally-servers\" must be a non-negative "
+          "integer.");
+    }
+
     // Get seed for rng
     if (settnode["seed"] && settnode["seed"].IsScalar()) {
       settings::rng_seed = settnode["seed"].as<uint64_t>();
@@ -858,6 +1002,17 @@ void make_settings(const YAML::Node& input) {
           "value.");
     }
 
+    // Get option for distributing particles based on the speed of each rank
+    if (settnode["adaptive-distribution"] &&
+        settnode["adaptive-distribution"].IsScalar()) {
+      settings::adaptive_distribution =
+          settnode["adaptive-distribution"].as<bool>();
+    } else if (settnode["adaptive-distribution"]) {
+      fatal_error(
+          "The settings option \"adaptive-distribution\" must be a single "
+          "boolean value.");
+    }
+
   } else {
     fatal_error("Not settings specified in input file.");
   }
@@ -870,19 +1025,37 @@ void make_tallies(const YAML::Node& input) {
   tallies =
       std::make_shared<Tallies>(static_cast<double>(settings::nparticles));
 
-  if (!input["tallies"]) {
-    return;
-  } else if (!input["tallies"].IsSequence()) {
+  if (input["tallies"] && !input["tallies"].IsSequence()) {
     fatal_error("Tallies entry must be provided as a sequence.");
   }
 
   // Add all spatial mesh tallies to the tallies instance
-  for (size_t t = 0; t < input["tallies"].size(); t++) {
-    add_mesh_tally(*tallies, input["tallies"][t]);
+  if (input["tallies"]) {
+    for (size_t t = 0; t < input["tallies"].size(); t++) {
+      add_mesh_tally(*tallies, input["tallies"][t]);
+    }
   }
 
   if (settings::mode == settings::SimulationMode::NOISE) {
     tallies->set_keff(settings::keff);
+
+    // The first noise frequency uses the base tallies object. All other
+    // frequencies get their own copy of all the tallies.
+    frequency_tallies = {tallies};
+    for (std::size_t f = 1; f < settings::noise_frequencies.size(); f++) {
+      auto ftallies =
+          std::make_shared<Tallies>(static_cast<double>(settings::nparticles));
+
+      if (input["tallies"]) {
+        for (size_t t = 0; t < input["tallies"].size(); t++) {
+          add_mesh_tally(*ftallies, input["tallies"][t]);
+        }
+      }
+
+      ftallies->set_keff(settings::keff);
+      ftallies->set_stream_group("generations/frequency-" + std::to_string(f));
+      frequency_tallies.push_back(ftallies);
+    }
   }
 }
 
@@ -959,9 +1132,24 @@ void make_noise_sources(const YAML::Node& input) {
       settings::mode == settings::SimulationMode::NOISE) {
     fatal_error("No noise source specified for noise problem.");
   }
+
+  // All the frequency dependent factors of the sources are computed once
+  // here, as the noise frequencies are fixed for the whole simulation. The
+  // sources are also indexed, to quickly find those containing a collision.
+  if (settings::mode == settings::SimulationMode::NOISE) {
+    noise_maker.set_frequencies(settings::noise_frequencies);
+    noise_maker.build_source_grid();
+  }
 }
 
 void make_simulation() {
+  if (settings::restart &&
+      settings::mode != settings::SimulationMode::K_EIGENVALUE) {
+    fatal_error(
+        "Restarting from a checkpoint is only supported for k-eigenvalue "
+        "simulations.");
+  }
+
   switch (settings::mode) {
     case settings::SimulationMode::K_EIGENVALUE:
       if (!settings::regional_cancellation) {
@@ -995,11 +1183,11 @@ void make_simulation() {
     case settings::SimulationMode::NOISE:
       if (!settings::regional_cancellation &&
           !settings::regional_cancellation_noise) {
-        simulation =
-            std::make_shared<Noise>(tallies, transporter, sources, noise_maker);
+        simulation = std::make_shared<Noise>(
+            frequency_tallies, transporter, sources, noise_maker);
       } else {
-        simulation = std::make_shared<Noise>(tallies, transporter, sources,
-                                             cancelator, noise_maker);
+        simulation = std::make_shared<Noise>(
+            frequency_tallies, transporter, sources, cancelator, noise_maker);
       }
       break;
   }
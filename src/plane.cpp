@@ -26,9 +26,16 @@
 #include <utils/constants.hpp>
 #include <utils/error.hpp>
 
+#include <cmath>
+
 Plane::Plane(double A_, double B_, double C_, double D_, BoundaryType bound,
              uint32_t i_id, std::string i_name)
-    : Surface{bound, i_id, i_name}, A{A_}, B{B_}, C{C_}, D{D_} {}
+    : Surface{bound, i_id, i_name},
+      A{A_},
+      B{B_},
+      C{C_},
+      D{D_},
+      inv_norm{1. / std::sqrt(A_ * A_ + B_ * B_ + C_ * C_)} {}
 
 int Plane::sign(const Position& r, const Direction& u) const {
   const double eval = A * r.x() + B * r.y() + C * r.z() - D;
@@ -57,6 +64,10 @@ double Plane::distance(const Position& r, const Direction& u,
     return d;
 }
 
+double Plane::safety(const Position& r) const {
+  return std::abs(A * r.x() + B * r.y() + C * r.z() - D) * inv_norm;
+}
+
 Direction Plane::norm(const Position& /*r*/) const { return {A, B, C}; }
 
 //===========================================================================
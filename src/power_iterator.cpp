@@ -31,19 +31,24 @@
 #include <utils/settings.hpp>
 #include <utils/timer.hpp>
 
-#include <highfive/H5File.hpp>
-namespace H5 = HighFive;
-
 #include <cmath>
+#include <filesystem>
 #include <fstream>
 #include <iomanip>
 #include <ios>
 #include <iostream>
 #include <numeric>
+#include <optional>
 #include <sstream>
 #include <vector>
 
 void PowerIterator::initialize() {
+  // If restarting, the bank and all other state comes from the checkpoint
+  if (settings::restart) {
+    read_checkpoint();
+    return;
+  }
+
   // If not using source file
   if (settings::load_source_file == false) {
     sample_source_from_sources();
@@ -57,98 +62,95 @@ void PowerIterator::initialize() {
   for (auto& p : bank) p.set_family_id(p.history_id());
 }
 
-void PowerIterator::load_source_from_file() {
-  // Load source file
-  auto h5s = H5::File(settings::in_source_file_name, H5::File::ReadOnly);
+void PowerIterator::load_source_from_file() { load_source_file(bank); }
+
+void PowerIterator::write_checkpoint() {
+  // The checkpoint is first written to a temporary file, which then replaces
+  // the previous checkpoint. This way, a complete checkpoint always exists,
+  // even if the run is killed while one is being written.
+  const std::string tmp_name = settings::checkpoint_file_name + ".tmp";
 
-  // Get the dataset and dimensions
-  auto source_ds = h5s.getDataSet("source");
-  std::vector<std::size_t> dimensions = source_ds.getSpace().getDimensions();
+  // Gathering the batches may record a batch, which queues background
+  // writes, so this is done before waiting for the writes to finish.
+  tallies->gather_mesh_tally_batches();
+  Output::instance().wait_for_writes();
+  std::optional<H5::File> checkpoint;
+  if (mpi::rank == 0) checkpoint.emplace(tmp_name, H5::File::Truncate);
+
+  write_checkpoint_state(checkpoint ? &checkpoint.value() : nullptr, bank);
+
+  if (mpi::rank != 0) return;
 
-  // Check dimensions
-  if (dimensions.size() != 2 || dimensions[1] != 9) {
-    fatal_error("Invalid source from file dimensions.");
+  checkpoint->createAttribute("generation", gen);
+  checkpoint->createAttribute<bool>("converged", settings::converged);
+
+  // Master is the only node which uses the global rng
+  std::stringstream rng_state;
+  rng_state << settings::rng;
+  checkpoint->createAttribute("rng", rng_state.str());
+
+  checkpoint->createDataSet("families", families_vec);
+  checkpoint->createDataSet("pair-dist-sqrd", r_sqrd_vec);
+  checkpoint->createDataSet("Nnet", Nnet_vec);
+  checkpoint->createDataSet("Ntot", Ntot_vec);
+  checkpoint->createDataSet("Npos", Npos_vec);
+  checkpoint->createDataSet("Nneg", Nneg_vec);
+  checkpoint->createDataSet("Wnet", Wnet_vec);
+  checkpoint->createDataSet("Wtot", Wtot_vec);
+  checkpoint->createDataSet("Wpos", Wpos_vec);
+  checkpoint->createDataSet("Wneg", Wneg_vec);
+
+  checkpoint->flush();
+  checkpoint.reset();
+  std::filesystem::rename(tmp_name, settings::checkpoint_file_name);
+}
+
+void PowerIterator::read_checkpoint() {
+  if (!std::filesystem::exists(settings::restart_file_name)) {
+    fatal_error("Could not find the checkpoint file " +
+                settings::restart_file_name + ".");
   }
 
-  // Read in array
-  NDArray<double> source = NDArray<double>(dimensions);
-  source_ds.read<double>(&source[0]);
+  Output::instance().write(" Restarting from checkpoint " +
+                           settings::restart_file_name + "...\n");
 
-  // Get number of particles
-  std::size_t Nprt = source.shape()[0];
+  // All nodes open the checkpoint, as it is only read
+  auto checkpoint = H5::File(settings::restart_file_name, H5::File::ReadOnly);
 
-  // Calculate the base number of particles per node to run
-  uint64_t base_particles_per_node =
-      static_cast<uint64_t>(Nprt / static_cast<std::size_t>(mpi::size));
-  uint64_t remainder =
-      static_cast<uint64_t>(Nprt % static_cast<std::size_t>(mpi::size));
+  read_checkpoint_state(checkpoint, bank);
 
-  // Set the base number of particles per node in the node_nparticles vector
-  mpi::node_nparticles.resize(static_cast<std::size_t>(mpi::size),
-                              base_particles_per_node);
+  gen = checkpoint.getAttribute("generation").read<int>();
+  restart_gen = gen;
+  settings::converged = checkpoint.getAttribute("converged").read<bool>();
 
-  // Distribute the remainder particles amonst the nodes. There are at most
-  // mpi::size-1 remainder particles, so we will distribute them untill we
-  // have no more.
-  for (std::size_t rank = 0; rank < remainder; rank++) {
-    mpi::node_nparticles[rank]++;
-  }
+  std::stringstream rng_state(
+      checkpoint.getAttribute("rng").read<std::string>());
+  rng_state >> settings::rng;
 
-  // Now we need to make sure that the history_counter for each node is at
-  // the right starting location.
-  for (int lower_rank = 0; lower_rank < mpi::rank; lower_rank++) {
-    histories_counter +=
-        mpi::node_nparticles[static_cast<std::size_t>(lower_rank)];
-  }
-
-  // Each node starts reading the input source data at their histories_counter
-  // index. It then reads its assigned number of particles.
-  uint64_t file_start_loc = histories_counter;
-  double tot_wgt = 0.;
-  for (std::size_t i = 0;
-       i < mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)]; i++) {
-    double x = source[(file_start_loc + i) * 9 + 0];
-    double y = source[(file_start_loc + i) * 9 + 1];
-    double z = source[(file_start_loc + i) * 9 + 2];
-    double ux = source[(file_start_loc + i) * 9 + 3];
-    double uy = source[(file_start_loc + i) * 9 + 4];
-    double uz = source[(file_start_loc + i) * 9 + 5];
-    double E = source[(file_start_loc + i) * 9 + 6];
-    double w = source[(file_start_loc + i) * 9 + 7];
-    double w2 = source[(file_start_loc + i) * 9 + 8];
-
-    bank.push_back({{x, y, z}, {ux, uy, uz}, E, w, histories_counter++});
-    bank.back().set_weight2(w2);
-    bank.back().initialize_rng(settings::rng_seed, settings::rng_stride);
-    tot_wgt += w;
-  }
-  global_histories_counter = Nprt;
-
-  mpi::Allreduce_sum(tot_wgt);
-
-  Output::instance().write(
-      " Total Weight of System: " + std::to_string(std::round(tot_wgt)) + "\n");
-  settings::nparticles = static_cast<int>(std::round(tot_wgt));
-  tallies->set_total_weight(std::round(tot_wgt));
+  families_vec =
+      checkpoint.getDataSet("families").read<std::vector<std::size_t>>();
+  r_sqrd_vec =
+      checkpoint.getDataSet("pair-dist-sqrd").read<std::vector<double>>();
+  Nnet_vec = checkpoint.getDataSet("Nnet").read<std::vector<int>>();
+  Ntot_vec = checkpoint.getDataSet("Ntot").read<std::vector<int>>();
+  Npos_vec = checkpoint.getDataSet("Npos").read<std::vector<int>>();
+  Nneg_vec = checkpoint.getDataSet("Nneg").read<std::vector<int>>();
+  Wnet_vec = checkpoint.getDataSet("Wnet").read<std::vector<int>>();
+  Wtot_vec = checkpoint.getDataSet("Wtot").read<std::vector<int>>();
+  Wpos_vec = checkpoint.getDataSet("Wpos").read<std::vector<int>>();
+  Wneg_vec = checkpoint.getDataSet("Wneg").read<std::vector<int>>();
+
+  if (gen >= settings::ngenerations) {
+    warning("The checkpoint is already at generation " + std::to_string(gen) +
+            ", which is not less than the number of generations.");
+  }
 }
 
 void PowerIterator::sample_source_from_sources() {
   Output::instance().write(" Generating source particles...\n");
-  // Calculate the base number of particles per node to run
-  uint64_t base_particles_per_node =
-      static_cast<uint64_t>(settings::nparticles / mpi::size);
-  uint64_t remainder = static_cast<uint64_t>(settings::nparticles % mpi::size);
-
-  // Set the base number of particles per node in the node_nparticles vector
-  mpi::node_nparticles.resize(static_cast<std::size_t>(mpi::size),
-                              base_particles_per_node);
-
-  // Distribute the remainder particles amonst the nodes. There are at most
-  // mpi::size-1 remainder particles, so we will distribute them untill we
-  // have no more.
-  for (std::size_t rank = 0; rank < remainder; rank++) {
-    mpi::node_nparticles[rank]++;
-  }
+  // Calculate the number of particles per node to run
+  mpi::node_nparticles =
+      mpi::split(static_cast<uint64_t>(settings::nparticles));
 
   // Now we need to make sure that the history_counter for each node is at
   // the right starting location.
@@ -227,7 +229,7 @@ void PowerIterator::generation_output() {
 
   double kcol = tallies->kcol();
 
-  if (gen == 1) print_header();
+  if (gen == restart_gen + 1) print_header();
 
   // First get the number of columns required to print the max generation number
   int n_col_gen =
@@ -320,7 +322,10 @@ void PowerIterator::run() {
   // Check for imediate convergence (i.e. we read source from file)
   if (settings::nignored == 0) settings::converged = true;
 
-  for (int g = 1; g <= settings::ngenerations; g++) {
+  // Number of generations requested, before any early stop
+  const int requested_ngenerations = settings::ngenerations;
+
+  for (int g = restart_gen + 1; g <= settings::ngenerations; g++) {
     gen = g;
 
     if (settings::families) {
@@ -330,13 +335,25 @@ void PowerIterator::run() {
       for (auto& p : bank) families.insert(p.family_id());
     }
 
+    // The bank is cleared by the transport, so the number of particles is
+    // kept for the rank weights.
+    const uint64_t nprt = bank.size();
+    transport_timer.reset();
+    transport_timer.start();
     std::vector<BankedParticle> next_gen = transporter->transport(bank);
+    transport_timer.stop();
     transported_histories += bank.size();
+    update_rank_weights(nprt);
 
     if (next_gen.size() == 0) {
       fatal_error("No fission neutrons were produced.");
     }
 
+    // Start sending all particles to master for cancellation and
+    // normalization/combing. The pre-cancellation entropy and the new keff
+    // are computed while the particles are in flight.
+    mpi::Request to_master = particles_to_master(next_gen);
+
     // Do all Pre-Cancelation entropy calculations
     compute_pre_cancellation_entropy(next_gen);
 
@@ -345,10 +362,7 @@ void PowerIterator::run() {
 
     // std::sort(next_gen.begin(), next_gen.end()); // This shouldn't be
     // necessary, as fission progeny should naturally be sorted
-    mpi::synchronize();
-
-    // Send all particles to master for cancellation and normalization/combing
-    particles_to_master(next_gen);
+    to_master.wait();
 
     // Do weight cancelation
     if (settings::regional_cancellation && cancelator && mpi::rank == 0) {
@@ -408,6 +422,7 @@ void PowerIterator::run() {
 
     // Output
     generation_output();
+    stream_entropy();
 
     // Check if signal has been sent after generation keff has been
     // recorded, and cancellation has occured. Otherwize source file
@@ -426,6 +441,21 @@ void PowerIterator::run() {
     // Once ignored generations are finished, mark as true to start
     // doing tallies
     if (g == settings::nignored) settings::converged = true;
+
+    // Write a checkpoint periodically, and whenever stopping early, so that
+    // the simulation can be continued with --restart. Checkpoints are not
+    // available with tally servers.
+    const bool stopping_early = g == settings::ngenerations &&
+                                g < requested_ngenerations;
+    if (settings::tally_servers == 0 &&
+        (stopping_early || (settings::checkpoint_interval > 0 &&
+                            g % settings::checkpoint_interval == 0))) {
+      write_checkpoint();
+      if (stopping_early) {
+        out.write(" Checkpoint written to " + settings::checkpoint_file_name +
+                  ".\n");
+      }
+    }
   }
 
   // Stop timer
@@ -718,7 +748,8 @@ void PowerIterator::premature_kill() {
 
 bool PowerIterator::out_of_time(int gen) {
   // Get the average time per generation
-  double T_avg = simulation_timer.elapsed_time() / static_cast<double>(gen);
+  double T_avg = simulation_timer.elapsed_time() /
+                 static_cast<double>(gen - restart_gen);
 
   // See how much time we have used so far.
   double T_used = settings::alpha_omega_timer.elapsed_time();
@@ -28,6 +28,7 @@
 #include <utils/constants.hpp>
 #include <utils/error.hpp>
 
+#include <algorithm>
 #include <cmath>
 
 RectLattice::RectLattice(uint32_t nx, uint32_t ny, uint32_t nz, double px,
@@ -129,14 +130,17 @@ UniqueCell RectLattice::get_cell(Position r, Direction u,
   }
 }
 
-UniqueCell RectLattice::get_cell(std::vector<GeoLilyPad>& stack, Position r,
-                                 Direction u, int32_t on_surf) const {
+UniqueCell RectLattice::get_cell(GeoStack& stack, Position r, Direction u,
+                                 int32_t on_surf) const {
   // Get index of each axis
   auto tile = get_tile(r, u);
   int nx = tile[0];
   int ny = tile[1];
   int nz = tile[2];
 
+  // The center of the tile is cached in the stack, for the Tracker
+  const Position center = tile_center(nx, ny, nz);
+
   UniqueCell ucell;
 
   if ((nx < 0 || nx >= static_cast<int>(Nx)) ||
@@ -145,8 +149,8 @@ UniqueCell RectLattice::get_cell(std::vector<GeoLilyPad>& stack, Position r,
     // Index is outside of lattice, if outside_universe, try outer_universe
     if (outer_universe_index >= 0) {
       // Save lattice info to stack
-      stack.push_back(
-          {GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz}, true});
+      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz},
+                       true, center});
 
       // Go to outside universe
       ucell =
@@ -156,8 +160,8 @@ UniqueCell RectLattice::get_cell(std::vector<GeoLilyPad>& stack, Position r,
       return ucell;
     } else {
       // Save lattice info to stack
-      stack.push_back(
-          {GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz}, false});
+      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz},
+                       false, center});
 
       // Location can not be found, return nullptr
       return ucell;
@@ -169,12 +173,12 @@ UniqueCell RectLattice::get_cell(std::vector<GeoLilyPad>& stack, Position r,
     if (lattice_universes[lin_indx] >= 0) {
       // Element is a valid fill, get cell from that universe
       // Transform coordinates to lattice elements locale frame
-      Position r_local = r - tile_center(nx, ny, nz);
+      Position r_local = r - center;
       const int32_t univ_indx = lattice_universes[lin_indx];
 
       // Save lattice info to stack
-      stack.push_back(
-          {GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz}, false});
+      stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz},
+                       false, center});
 
       ucell =
           geometry::universes[static_cast<std::size_t>(univ_indx)]->get_cell(
@@ -185,8 +189,8 @@ UniqueCell RectLattice::get_cell(std::vector<GeoLilyPad>& stack, Position r,
       // Element is a dummy, try outer_universe
       if (outer_universe_index >= 0) {
         // Save lattice info to stack
-        stack.push_back(
-            {GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz}, true});
+        stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz},
+                         true, center});
 
         // outer_universe is give, get cell from that
         ucell =
@@ -196,8 +200,8 @@ UniqueCell RectLattice::get_cell(std::vector<GeoLilyPad>& stack, Position r,
         return ucell;
       } else {
         // Save lattice info to stack
-        stack.push_back(
-            {GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz}, false});
+        stack.push_back({GeoLilyPad::PadType::Lattice, id_, r, {nx, ny, nz},
+                         false, center});
 
         // No outer_universe provided, return nullptr
         return ucell;
@@ -242,8 +246,10 @@ double RectLattice::distance_to_tile_boundary(
   Position center = tile_center(tile[0], tile[1], tile[2]);
 
   // Position relatice to center of tile
-  Position r_tile = r_local - center;
+  return distance_in_tile(r_local - center, u);
+}
 
+double RectLattice::distance_in_tile(Position r_tile, Direction u) const {
   double dist = INF;
 
   // Check all surfaces
@@ -281,6 +287,14 @@ double RectLattice::distance_to_tile_boundary(
   return dist;
 }
 
+double RectLattice::safety_in_tile(Position r_tile) const {
+  const double sx = Px * 0.5 - std::abs(r_tile.x());
+  const double sy = Py * 0.5 - std::abs(r_tile.y());
+  const double sz = Pz * 0.5 - std::abs(r_tile.z());
+
+  return std::max(std::min({sx, sy, sz}), 0.);
+}
+
 void RectLattice::set_elements(std::vector<int32_t> univs) {
   if (univs.size() == (Nx * Ny * Nz)) {
     lattice_universes = univs;
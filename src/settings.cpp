@@ -63,7 +63,8 @@ double wgt_cutoff = 0.25;
 double wgt_survival = 1.0;
 double wgt_split = 2.0;
 
-double w_noise = -1.;
+double w_noise = -1.;  // Frequency of the noise batch being transported
+std::vector<double> noise_frequencies;
 double eta = 1.;   // Used in noise transport
 double keff = 1.;  // Used in noise transport
 
@@ -75,15 +76,33 @@ bool pair_distance_sqrd = false;
 bool families = false;
 bool empty_entropy_bins = false;
 
+bool adaptive_distribution = false;
+
 bool regional_cancellation = false;
 bool regional_cancellation_noise = false;
 
 bool inner_generations = true;
 bool normalize_noise_source = true;
 bool rng_stride_warnings = false;
+bool flatten_geometry = true;
 
 bool load_source_file = false;
 
+bool source_float32 = false;
+int source_compression = 0;
+
+int checkpoint_interval = 0;
+std::string checkpoint_file_name = "checkpoint.h5";
+bool restart = false;
+std::string restart_file_name = "";
+
+bool stream_generations = false;
+int stream_queue_size = 256;
+
+int tally_batch_size = 1;
+
+int tally_servers = 0;
+
 bool branchless_splitting = false;
 bool branchless_combing = true;
 bool branchless_material = true;
@@ -154,7 +173,11 @@ void write_settings_to_output() {
   if (mode == SimulationMode::NOISE) {
     h5.createAttribute("nskip", nskip);
 
-    h5.createAttribute("noise-angular-frequency", w_noise);
+    if (noise_frequencies.size() == 1) {
+      h5.createAttribute("noise-angular-frequency", noise_frequencies.front());
+    } else {
+      h5.createAttribute("noise-angular-frequency", noise_frequencies);
+    }
 
     h5.createAttribute("keff", keff);
 
@@ -236,6 +259,8 @@ void write_settings_to_output() {
 
   h5.createAttribute("rng-stride-warnings", rng_stride_warnings);
 
+  h5.createAttribute("flatten-geometry", flatten_geometry);
+
   h5.createAttribute("seed", rng_seed);
 
   h5.createAttribute("stride", rng_stride);
@@ -257,5 +282,23 @@ void write_settings_to_output() {
   h5.createAttribute<bool>("families", families);
 
   h5.createAttribute<bool>("empty-entropy-bins", empty_entropy_bins);
+
+  h5.createAttribute<bool>("adaptive-distribution", adaptive_distribution);
+
+  h5.createAttribute<bool>("source-float32", source_float32);
+
+  h5.createAttribute("source-compression", source_compression);
+
+  h5.createAttribute("checkpoint-interval", checkpoint_interval);
+
+  h5.createAttribute<bool>("restart", restart);
+
+  h5.createAttribute<bool>("stream-generations", stream_generations);
+
+  h5.createAttribute("stream-queue-size", stream_queue_size);
+
+  h5.createAttribute("tally-batch-size", tally_batch_size);
+
+  h5.createAttribute("tally-servers", tally_servers);
 }
 }  // namespace settings
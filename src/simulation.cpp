@@ -27,7 +27,14 @@
 #include <utils/output.hpp>
 #include <utils/settings.hpp>
 
-#include <ndarray.hpp>
+#include <highfive/H5File.hpp>
+namespace H5 = HighFive;
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <type_traits>
+#include <utility>
 
 Simulation::Simulation(std::shared_ptr<Tallies> i_t,
                        std::shared_ptr<Transporter> i_tr,
@@ -76,11 +83,57 @@ std::vector<Particle> Simulation::sample_sources(std::size_t N) {
   return source_particles;
 }
 
+void Simulation::stream_entropy() const {
+  if (!settings::stream_generations || mpi::rank != 0) return;
+
+  // Names and values of all entropies computed for the last generation
+  std::vector<std::pair<std::string, double>> entropies;
+  if (t_pre_entropy_vec.size() > 0 &&
+      settings::regional_cancellation == false) {
+    entropies.push_back({"entropy", t_pre_entropy_vec.back()});
+  } else if (t_pre_entropy_vec.size() > 0) {
+    entropies.push_back(
+        {"total-pre-cancel-entropy", t_pre_entropy_vec.back()});
+    entropies.push_back({"neg-pre-cancel-entropy", n_pre_entropy_vec.back()});
+    entropies.push_back({"pos-pre-cancel-entropy", p_pre_entropy_vec.back()});
+
+    if (t_post_entropy_vec.size() > 0) {
+      entropies.push_back(
+          {"total-post-cancel-entropy", t_post_entropy_vec.back()});
+      entropies.push_back(
+          {"neg-post-cancel-entropy", n_post_entropy_vec.back()});
+      entropies.push_back(
+          {"pos-post-cancel-entropy", p_post_entropy_vec.back()});
+    }
+  }
+
+  if (settings::empty_entropy_bins && empty_entropy_frac_vec.size() > 0) {
+    entropies.push_back({"empty-entropy-frac", empty_entropy_frac_vec.back()});
+  }
+
+  if (entropies.empty()) return;
+
+  const std::size_t nbytes = entropies.size() * sizeof(double);
+  Output::instance().write_async(
+      [entropies = std::move(entropies)](H5::File& h5) {
+        for (const auto& [name, val] : entropies) {
+          append_row(h5, "generations/" + name, {val});
+        }
+      },
+      nbytes);
+}
+
 void Simulation::sync_signaled() {
   mpi::Allreduce_or(signaled);
   mpi::Allreduce_or(terminate);
 }
 
+void Simulation::update_rank_weights(std::size_t nparticles) {
+  if (!settings::adaptive_distribution) return;
+
+  mpi::update_rank_weights(nparticles, transport_timer.elapsed_time());
+}
+
 void Simulation::sync_banks(std::vector<uint64_t>& nums,
                             std::vector<BankedParticle>& bank) {
   uint64_t pre_Ntot = bank.size();
@@ -104,22 +157,14 @@ void Simulation::sync_banks(std::vector<uint64_t>& nums,
     Output::instance().write("\n post_Ntot != pre_Ntot\n");
 
   // Make sure each node know how many particles the other has
-  nums[static_cast<std::size_t>(mpi::rank)] = bank.size();
-  for (int n = 0; n < mpi::size; n++) {
-    mpi::Bcast<uint64_t>(nums[static_cast<std::size_t>(n)], n);
-  }
+  mpi::Allgather<uint64_t>(bank.size(), nums);
 }
 
-void Simulation::particles_to_master(std::vector<BankedParticle>& bank) {
-  // First, we send all particles to the master
-  mpi::Gatherv(bank, 0);
-
-  // Now we sort the particles
-  if (mpi::rank == 0) {
-    // std::sort(bank.begin(), bank.end()); // Shouldn't be necessary
-  } else {
-    bank.clear();
-  }
+mpi::Request Simulation::particles_to_master(
+    std::vector<BankedParticle>& bank) {
+  // Send all particles to the master. Once the request is complete, the
+  // bank is empty on all other nodes.
+  return mpi::Igatherv(bank, 0);
 }
 
 void Simulation::distribute_particles(std::vector<uint64_t>& nums,
@@ -128,48 +173,306 @@ void Simulation::distribute_particles(std::vector<uint64_t>& nums,
   mpi::Scatterv(bank, 0);
 
   // Make sure each node know how many particles the other has
-  nums[static_cast<std::size_t>(mpi::rank)] = bank.size();
-  for (int n = 0; n < mpi::size; n++) {
-    mpi::Bcast<uint64_t>(nums[static_cast<std::size_t>(n)], n);
+  mpi::Allgather<uint64_t>(bank.size(), nums);
+}
+
+// Number of columns of the source dataset: x, y, z, ux, uy, uz, E, wgt, wgt2
+constexpr std::size_t SOURCE_NCOLS = 9;
+
+// Number of rows which are read, sent, or written at once
+constexpr uint64_t SOURCE_CHUNK_ROWS = 1 << 16;
+
+// Tag of the messages used to send chunks of rows to master
+constexpr int ROWS_TAG = 4242;
+
+// Reads the rows [start, start + nrows) of a dataset with ncols columns, one
+// chunk at a time, and passes each chunk to use_rows. The values are
+// converted to T if the dataset was written with another precision.
+template <typename T, typename UseRows>
+static void read_rows(const H5::DataSet& dset, std::size_t ncols,
+                      uint64_t start, uint64_t nrows, UseRows use_rows) {
+  std::vector<T> rows;
+  for (uint64_t offset = 0; offset < nrows; offset += SOURCE_CHUNK_ROWS) {
+    const uint64_t n = std::min(SOURCE_CHUNK_ROWS, nrows - offset);
+    rows.resize(n * ncols);
+    dset.select({start + offset, 0}, {n, ncols}).read_raw<T>(rows.data());
+    use_rows(rows);
   }
 }
 
-void Simulation::write_source(std::vector<Particle>& bank) const {
-  // Convert the vector of particles to a vector of BakedParticle
-  std::vector<BankedParticle> tmp_bank(bank.size());
-  for (std::size_t i = 0; i < bank.size(); i++) {
-    tmp_bank[i].r = bank[i].r();
-    tmp_bank[i].u = bank[i].u();
-    tmp_bank[i].E = bank[i].E();
-    tmp_bank[i].wgt = bank[i].wgt();
+// Writes a dataset with ncols columns, holding the rows of all nodes in rank
+// order. Only master has the file open, and it receives and writes the rows
+// of the other nodes one chunk at a time, instead of gathering them all.
+// fill_rows(offset, rows) fills rows with the chunk of the nrows rows of this
+// node which starts at offset. The values are stored as Stored.
+template <typename Stored, typename T, typename FillRows>
+static void write_rows(H5::File* h5, const std::string& name,
+                       std::size_t ncols, uint64_t nrows, int compression,
+                       FillRows fill_rows) {
+  // Get the number of rows on each node, and the total
+  std::vector<uint64_t> nums;
+  mpi::Allgather<uint64_t>(nrows, nums);
+  const uint64_t Ntot = std::accumulate(nums.begin(), nums.end(), uint64_t{0});
+
+  std::vector<T> rows;
+  if (mpi::rank != 0) {
+    // Send our rows to master, one chunk at a time
+    for (uint64_t offset = 0; offset < nrows; offset += SOURCE_CHUNK_ROWS) {
+      fill_rows(offset, rows);
+      mpi::Send(rows, 0, ROWS_TAG);
+    }
+    return;
+  }
+
+  // Create the dataset, chunked so that it may be compressed
+  H5::DataSetCreateProps props;
+  const uint64_t chunk_rows =
+      std::max<uint64_t>(1, std::min(Ntot, SOURCE_CHUNK_ROWS));
+  props.add(H5::Chunking(std::vector<hsize_t>{chunk_rows, ncols}));
+  if (compression > 0) {
+    props.add(H5::Shuffle());
+    props.add(H5::Deflate(static_cast<unsigned>(compression)));
   }
+  auto dset =
+      h5->createDataSet<Stored>(name, H5::DataSpace({Ntot, ncols}), props);
 
-  // Send all particles to the master process, so that all fission
-  // sites can be written to a single npy file.
-  mpi::Gatherv(tmp_bank, 0);
+  uint64_t row = 0;
+  auto write_chunk = [&dset, &row, ncols](const std::vector<T>& chunk) {
+    const uint64_t n = chunk.size() / ncols;
+    if (n == 0) return;
 
-  if (mpi::rank == 0) {
-    // Make an NDArray to contain all particles info first
-    NDArray<double> source({tmp_bank.size(), 9});
-
-    // Add all particles to the array
-    for (std::size_t i = 0; i < tmp_bank.size(); i++) {
-      const auto& p = tmp_bank[i];
-
-      source[i * 9 + 0] = p.r.x();
-      source[i * 9 + 1] = p.r.y();
-      source[i * 9 + 2] = p.r.z();
-      source[i * 9 + 3] = p.u.x();
-      source[i * 9 + 4] = p.u.y();
-      source[i * 9 + 5] = p.u.z();
-      source[i * 9 + 6] = p.E;
-      source[i * 9 + 7] = p.wgt;
-      source[i * 9 + 8] = p.wgt2;
+    if constexpr (std::is_same_v<Stored, T>) {
+      dset.select({row, 0}, {n, ncols}).write_raw(chunk.data());
+    } else {
+      std::vector<Stored> tmp(chunk.begin(), chunk.end());
+      dset.select({row, 0}, {n, ncols}).write_raw(tmp.data());
+    }
+    row += n;
+  };
+
+  // Write our own rows first, followed by those of each node in order
+  for (uint64_t offset = 0; offset < nrows; offset += SOURCE_CHUNK_ROWS) {
+    fill_rows(offset, rows);
+    write_chunk(rows);
+  }
+
+  for (int n = 1; n < mpi::size; n++) {
+    const uint64_t nrows_node = nums[static_cast<std::size_t>(n)];
+    for (uint64_t offset = 0; offset < nrows_node;
+         offset += SOURCE_CHUNK_ROWS) {
+      mpi::Recv(rows, n, ROWS_TAG);
+      write_chunk(rows);
     }
+  }
+}
 
-    auto& h5 = Output::instance().h5();
-    auto source_dset =
-        h5.createDataSet<double>("source", H5::DataSpace(source.shape()));
-    source_dset.write_raw(&source[0]);
+// Fills rows with the chunk of particles of the bank which starts at offset,
+// in the layout of the source dataset.
+static void fill_source_rows(const std::vector<Particle>& bank,
+                             uint64_t offset, std::vector<double>& rows) {
+  const uint64_t nrows =
+      std::min<uint64_t>(SOURCE_CHUNK_ROWS, bank.size() - offset);
+  rows.resize(nrows * SOURCE_NCOLS);
+  for (std::size_t i = 0; i < nrows; i++) {
+    const Particle& p = bank[offset + i];
+    double* row = &rows[i * SOURCE_NCOLS];
+    row[0] = p.r().x();
+    row[1] = p.r().y();
+    row[2] = p.r().z();
+    row[3] = p.u().x();
+    row[4] = p.u().y();
+    row[5] = p.u().z();
+    row[6] = p.E();
+    row[7] = p.wgt();
+    row[8] = p.wgt2();
   }
 }
+
+// Adds the particles of a chunk of rows of the source dataset to the bank,
+// giving them consecutive history ids starting at histories_counter.
+static void push_source_rows(const std::vector<double>& rows,
+                             std::vector<Particle>& bank,
+                             uint64_t& histories_counter) {
+  for (std::size_t i = 0; i < rows.size() / SOURCE_NCOLS; i++) {
+    const double* row = &rows[i * SOURCE_NCOLS];
+    double x = row[0];
+    double y = row[1];
+    double z = row[2];
+    double ux = row[3];
+    double uy = row[4];
+    double uz = row[5];
+    double E = row[6];
+    double w = row[7];
+    double w2 = row[8];
+
+    bank.push_back({{x, y, z}, {ux, uy, uz}, E, w, histories_counter++});
+    bank.back().set_weight2(w2);
+    bank.back().initialize_rng(settings::rng_seed, settings::rng_stride);
+  }
+}
+
+void Simulation::load_source_file(std::vector<Particle>& bank) {
+  // Open the source file. Each node opens it independently, as it is only
+  // read, and only reads the rows for its own particles.
+  auto h5s = H5::File(settings::in_source_file_name, H5::File::ReadOnly);
+
+  // Get the dataset and dimensions
+  auto source_ds = h5s.getDataSet("source");
+  std::vector<std::size_t> dimensions = source_ds.getSpace().getDimensions();
+
+  // Check dimensions
+  if (dimensions.size() != 2 || dimensions[1] != SOURCE_NCOLS) {
+    fatal_error("Invalid source from file dimensions.");
+  }
+
+  // Get number of particles
+  const uint64_t Nprt = dimensions[0];
+
+  // Calculate the number of particles per node to run
+  mpi::node_nparticles = mpi::split(Nprt);
+
+  // Now we need to make sure that the history_counter for each node is at
+  // the right starting location.
+  for (int lower_rank = 0; lower_rank < mpi::rank; lower_rank++) {
+    histories_counter +=
+        mpi::node_nparticles[static_cast<std::size_t>(lower_rank)];
+  }
+
+  // Each node starts reading the input source data at their histories_counter
+  // index. It then reads its assigned number of particles, one chunk at a
+  // time.
+  const uint64_t file_start_loc = histories_counter;
+  const uint64_t node_nprt =
+      mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)];
+  const std::size_t first = bank.size();
+  bank.reserve(bank.size() + node_nprt);
+  read_rows<double>(source_ds, SOURCE_NCOLS, file_start_loc, node_nprt,
+                    [this, &bank](const std::vector<double>& rows) {
+                      push_source_rows(rows, bank, histories_counter);
+                    });
+  global_histories_counter = Nprt;
+
+  double tot_wgt = 0.;
+  for (std::size_t i = first; i < bank.size(); i++) tot_wgt += bank[i].wgt();
+  mpi::Allreduce_sum(tot_wgt);
+
+  Output::instance().write(
+      " Total Weight of System: " + std::to_string(std::round(tot_wgt)) + "\n");
+  settings::nparticles = static_cast<int>(std::round(tot_wgt));
+  tallies->set_total_weight(std::round(tot_wgt));
+}
+
+void Simulation::write_source(std::vector<Particle>& bank) const {
+  H5::File* h5 = mpi::rank == 0 ? &Output::instance().h5() : nullptr;
+
+  auto fill_rows = [&bank](uint64_t offset, std::vector<double>& rows) {
+    fill_source_rows(bank, offset, rows);
+  };
+
+  if (settings::source_float32) {
+    write_rows<float, double>(h5, "source", SOURCE_NCOLS, bank.size(),
+                              settings::source_compression, fill_rows);
+  } else {
+    write_rows<double, double>(h5, "source", SOURCE_NCOLS, bank.size(),
+                               settings::source_compression, fill_rows);
+  }
+}
+
+void Simulation::write_checkpoint_state(
+    H5::File* checkpoint, const std::vector<Particle>& bank) const {
+  if (mpi::rank == 0) {
+    checkpoint->createAttribute("nparticles", settings::nparticles);
+    checkpoint->createAttribute("global-histories-counter",
+                                global_histories_counter);
+
+    checkpoint->createDataSet("p-pre-entropy", p_pre_entropy_vec);
+    checkpoint->createDataSet("n-pre-entropy", n_pre_entropy_vec);
+    checkpoint->createDataSet("t-pre-entropy", t_pre_entropy_vec);
+    checkpoint->createDataSet("p-post-entropy", p_post_entropy_vec);
+    checkpoint->createDataSet("n-post-entropy", n_post_entropy_vec);
+    checkpoint->createDataSet("t-post-entropy", t_post_entropy_vec);
+    checkpoint->createDataSet("empty-entropy-frac", empty_entropy_frac_vec);
+
+    auto tallies_grp = checkpoint->createGroup("tallies");
+    tallies->write_checkpoint(tallies_grp);
+  }
+
+  // The bank is saved with the layout of the source dataset, along with the
+  // family id of each particle.
+  write_rows<double, double>(
+      checkpoint, "bank", SOURCE_NCOLS, bank.size(), 0,
+      [&bank](uint64_t offset, std::vector<double>& rows) {
+        fill_source_rows(bank, offset, rows);
+      });
+
+  write_rows<uint64_t, uint64_t>(
+      checkpoint, "family-id", 1, bank.size(), 0,
+      [&bank](uint64_t offset, std::vector<uint64_t>& rows) {
+        const uint64_t nrows =
+            std::min<uint64_t>(SOURCE_CHUNK_ROWS, bank.size() - offset);
+        rows.resize(nrows);
+        for (std::size_t i = 0; i < nrows; i++) {
+          rows[i] = bank[offset + i].family_id();
+        }
+      });
+}
+
+void Simulation::read_checkpoint_state(const H5::File& checkpoint,
+                                       std::vector<Particle>& bank) {
+  settings::nparticles = checkpoint.getAttribute("nparticles").read<int>();
+  global_histories_counter =
+      checkpoint.getAttribute("global-histories-counter").read<uint64_t>();
+
+  auto read_vec = [&checkpoint](const std::string& name) {
+    return checkpoint.getDataSet(name).read<std::vector<double>>();
+  };
+  p_pre_entropy_vec = read_vec("p-pre-entropy");
+  n_pre_entropy_vec = read_vec("n-pre-entropy");
+  t_pre_entropy_vec = read_vec("t-pre-entropy");
+  p_post_entropy_vec = read_vec("p-post-entropy");
+  n_post_entropy_vec = read_vec("n-post-entropy");
+  t_post_entropy_vec = read_vec("t-post-entropy");
+  empty_entropy_frac_vec = read_vec("empty-entropy-frac");
+
+  tallies->read_checkpoint(checkpoint.getGroup("tallies"));
+
+  // Get the bank datasets, and check their dimensions
+  auto bank_ds = checkpoint.getDataSet("bank");
+  auto family_ds = checkpoint.getDataSet("family-id");
+  std::vector<std::size_t> dimensions = bank_ds.getDimensions();
+  if (dimensions.size() != 2 || dimensions[1] != SOURCE_NCOLS ||
+      family_ds.getDimensions() != std::vector<std::size_t>{dimensions[0], 1}) {
+    fatal_error("Invalid bank dimensions in the checkpoint.");
+  }
+  const uint64_t Nprt = dimensions[0];
+
+  // The particles are distributed among the nodes just as they were after
+  // the last generation, as long as the number of nodes is the same.
+  mpi::node_nparticles = mpi::split(Nprt);
+
+  // The particles of the bank were given the last Nprt history ids, in rank
+  // order, so they get the same ids, and therefore the same random number
+  // streams, as they had before the checkpoint was written.
+  const uint64_t bank_start_id = global_histories_counter - Nprt;
+  histories_counter = bank_start_id;
+  for (int lower_rank = 0; lower_rank < mpi::rank; lower_rank++) {
+    histories_counter +=
+        mpi::node_nparticles[static_cast<std::size_t>(lower_rank)];
+  }
+
+  const uint64_t file_start_loc = histories_counter - bank_start_id;
+  const uint64_t node_nprt =
+      mpi::node_nparticles[static_cast<std::size_t>(mpi::rank)];
+  bank.clear();
+  bank.reserve(node_nprt);
+  read_rows<double>(bank_ds, SOURCE_NCOLS, file_start_loc, node_nprt,
+                    [this, &bank](const std::vector<double>& rows) {
+                      push_source_rows(rows, bank, histories_counter);
+                    });
+
+  std::size_t i = 0;
+  read_rows<uint64_t>(family_ds, 1, file_start_loc, node_nprt,
+                      [&bank, &i](const std::vector<uint64_t>& rows) {
+                        for (uint64_t id : rows) bank[i++].set_family_id(id);
+                      });
+}
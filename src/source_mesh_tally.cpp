@@ -69,10 +69,7 @@ void SourceMeshTally::score_source(const BankedParticle& p) {
         scr *= p.wgt2;
         break;
     }
-#ifdef ABEILLE_USE_OMP
-#pragma omp atomic
-#endif
-    tally_gen(uE, ui, uj, uk) += scr;
+    add_score(uE, ui, uj, uk, scr);
   }
 }
 
@@ -165,7 +162,8 @@ std::shared_ptr<SourceMeshTally> make_source_mesh_tally(
   }
 
   return std::make_shared<SourceMeshTally>(plow, phi, nx, ny, nz, ebounds,
-                                           quantity, fname);
+                                           quantity, fname,
+                                           make_mesh_tally_storage(node));
 }
 
 std::string SourceMeshTally::quantity_str() const {
@@ -75,6 +75,13 @@ double Sphere::distance(const Position& r, const Direction& u,
   }
 }
 
+double Sphere::safety(const Position& r) const {
+  const double x = r.x() - x0;
+  const double y = r.y() - y0;
+  const double z = r.z() - z0;
+  return std::abs(std::sqrt(x * x + y * y + z * z) - R);
+}
+
 Direction Sphere::norm(const Position& r) const {
   return {r.x() - x0, r.y() - y0, r.z() - z0};
 }
@@ -24,16 +24,10 @@
  * */
 #include <materials/material_helper.hpp>
 #include <simulation/square_oscillation_noise_source.hpp>
-#include <simulation/tracker.hpp>
 #include <utils/constants.hpp>
-#include <utils/direction.hpp>
 #include <utils/error.hpp>
 
-#include <sstream>
-
-// This is here, just so I can use a Tracker to get materials fast,
-// without having the direction sent.
-const Direction u(1., 0., 0.);
+#include <cmath>
 
 SquareOscillationNoiseSource::SquareOscillationNoiseSource(
     Position low, Position hi, double eps_tot, double eps_fis, double eps_sct,
@@ -41,6 +35,7 @@ SquareOscillationNoiseSource::SquareOscillationNoiseSource(
     : low_(low),
       hi_(hi),
       w0_(angular_frequency),
+      amplitude_(),
       eps_t_(eps_tot),
       eps_f_(eps_fis),
       eps_s_(eps_sct) {
@@ -81,92 +76,50 @@ bool SquareOscillationNoiseSource::is_inside(const Position& r) const {
   return false;
 }
 
-std::complex<double> SquareOscillationNoiseSource::dEt(const Position& r,
-                                                       double E,
-                                                       double w) const {
-  // Get the material
-  Tracker trkr(r, u);
-  auto material = trkr.material();
-
-  // Make sure material is valid
-  if (!material) {
-    std::stringstream mssg;
-    mssg << "No material found at position " << r << ".";
-    fatal_error(mssg.str());
-  }
-
-  // Make material helper and evaluate XS
-  MaterialHelper mat(material, E);
-  double xs = mat.Et(E);
+void SquareOscillationNoiseSource::set_frequencies(
+    const std::vector<double>& w) {
+  amplitude_.assign(w.size(), 0.);
 
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
+  for (std::size_t f = 0; f < w.size(); f++) {
+    // Get the frequency multiple n
+    int32_t n = static_cast<int32_t>(std::round(w[f] / w0_));
 
-  double err = (n * w0_ - w) / w;
+    double err = (n * w0_ - w[f]) / w[f];
 
-  if ((n == 1 || n == -1) && std::abs(err) < 0.01) {
-    return {eps_t_ * xs * PI, 0.};
-  } else {
-    return {0., 0.};
+    if ((n == 1 || n == -1) && std::abs(err) < 0.01) {
+      amplitude_[f] = PI;
+    }
   }
 }
 
-std::complex<double> SquareOscillationNoiseSource::dEt_Et(const Position& /*r*/,
-                                                          double /*E*/,
-                                                          double w) const {
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
+std::complex<double> SquareOscillationNoiseSource::dEt(
+    const Position& /*r*/, MaterialHelper& mat, double E,
+    std::size_t freq) const {
+  if (amplitude_[freq] == 0.) return {0., 0.};
 
-  double err = (n * w0_ - w) / w;
-
-  if ((n == 1 || n == -1) && std::abs(err) < 0.01) {
-    return {eps_t_ * PI, 0.};
-  } else {
-    return {0., 0.};
-  }
+  return {eps_t_ * mat.Et(E) * amplitude_[freq], 0.};
 }
 
-std::complex<double> SquareOscillationNoiseSource::dEf_Ef(const Position& /*r*/,
-                                                          double /*E*/,
-                                                          double w) const {
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
-
-  double err = (n * w0_ - w) / w;
+std::complex<double> SquareOscillationNoiseSource::dEt_Et(
+    const Position& /*r*/, MaterialHelper& /*mat*/, double /*E*/,
+    std::size_t freq) const {
+  return {eps_t_ * amplitude_[freq], 0.};
+}
 
-  if ((n == 1 || n == -1) && std::abs(err) < 0.01) {
-    return {eps_f_ * PI, 0.};
-  } else {
-    return {0., 0.};
-  }
+std::complex<double> SquareOscillationNoiseSource::dEf_Ef(
+    const Position& /*r*/, double /*E*/, std::size_t freq) const {
+  return {eps_f_ * amplitude_[freq], 0.};
 }
 
 std::complex<double> SquareOscillationNoiseSource::dEelastic_Eelastic(
-    const Position& /*r*/, double /*E*/, double w) const {
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
-
-  double err = (n * w0_ - w) / w;
-
-  if ((n == 1 || n == -1) && std::abs(err) < 0.01) {
-    return {eps_s_ * PI, 0.};
-  } else {
-    return {0., 0.};
-  }
+    const Position& /*r*/, double /*E*/, std::size_t freq) const {
+  return {eps_s_ * amplitude_[freq], 0.};
 }
 
 std::complex<double> SquareOscillationNoiseSource::dEmt_Emt(
-    uint32_t /*mt*/, const Position& /*r*/, double /*E*/, double w) const {
-  // Get the frequency multiple n
-  int32_t n = static_cast<int32_t>(std::round(w / w0_));
-
-  double err = (n * w0_ - w) / w;
-
-  if ((n == 1 || n == -1) && std::abs(err) < 0.01) {
-    return {eps_s_ * PI, 0.};
-  } else {
-    return {0., 0.};
-  }
+    uint32_t /*mt*/, const Position& /*r*/, double /*E*/,
+    std::size_t freq) const {
+  return {eps_s_ * amplitude_[freq], 0.};
 }
 
 std::shared_ptr<OscillationNoiseSource> make_square_oscillation_noise_source(
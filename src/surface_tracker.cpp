@@ -40,6 +40,15 @@
 std::vector<BankedParticle> SurfaceTracker::transport(
     std::vector<Particle>& bank, bool noise,
     std::vector<BankedParticle>* noise_bank, const NoiseMaker* noise_maker) {
+  return dispatch_transport(noise, [&](auto mode) {
+    return transport_particles<decltype(mode)>(bank, noise_bank, noise_maker);
+  });
+}
+
+template <typename Mode>
+std::vector<BankedParticle> SurfaceTracker::transport_particles(
+    std::vector<Particle>& bank, std::vector<BankedParticle>* noise_bank,
+    const NoiseMaker* noise_maker) {
 #ifdef ABEILLE_USE_OMP
 #pragma omp parallel
 #endif
@@ -67,11 +76,11 @@ std::vector<BankedParticle> SurfaceTracker::transport(
       // Only make helper if we aren't lost, to make sure that material isn't
       // a nullptr. We also set the URR random variable here, if using ptables.
       MaterialHelper mat(trkr.material(), p.E());
-      if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+      if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
 
       while (p.is_alive()) {
         bool had_collision = false;
-        double d_coll = RNG::exponential(p.rng, mat.Et(p.E(), noise));
+        double d_coll = RNG::exponential(p.rng, mat.Et(p.E(), Mode::noise));
         auto bound = trkr.get_nearest_boundary();
 
         // score track length tally for boundary distance,
@@ -145,9 +154,10 @@ std::vector<BankedParticle> SurfaceTracker::transport(
         }
 
         if (p.is_alive() && had_collision) {  // real collision
-          collision(p, mat, thread_scores, noise, noise_maker);
+          collision<Mode::noise, Mode::branchless>(p, mat, thread_scores,
+                                                 noise_maker);
           trkr.set_u(p.u());
-          if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+          if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
         }  // If alive for real collision
 
         if (!p.is_alive()) {
@@ -168,7 +178,7 @@ std::vector<BankedParticle> SurfaceTracker::transport(
               fatal_error(mssg.str());
             }
             mat.set_material(trkr.material(), p.E());
-            if (settings::use_urr_ptables) mat.set_urr_rand_vals(p.rng);
+            if constexpr (Mode::urr) mat.set_urr_rand_vals(p.rng);
           } else if (settings::rng_stride_warnings) {
             // History is truly dead.
             // Check if we went past the particle stride.
@@ -77,26 +77,44 @@ Tallies::Tallies(double tot_wgt)
 void Tallies::add_collision_mesh_tally(
     std::shared_ptr<CollisionMeshTally> cetally) {
   cetally->set_net_weight(total_weight);
+  cetally->set_stream_group(stream_group_);
   collision_mesh_tallies_.push_back(cetally);
 }
 
 void Tallies::add_track_length_mesh_tally(
     std::shared_ptr<TrackLengthMeshTally> tltally) {
   tltally->set_net_weight(total_weight);
+  tltally->set_stream_group(stream_group_);
   track_length_mesh_tallies_.push_back(tltally);
 }
 
 void Tallies::add_source_mesh_tally(std::shared_ptr<SourceMeshTally> stally) {
   stally->set_net_weight(total_weight);
+  stally->set_stream_group(stream_group_);
   source_mesh_tallies_.push_back(stally);
 }
 
 void Tallies::add_noise_source_mesh_tally(
     std::shared_ptr<SourceMeshTally> stally) {
   stally->set_net_weight(total_weight);
+  stally->set_stream_group(stream_group_);
   noise_source_mesh_tallies_.push_back(stally);
 }
 
+void Tallies::set_stream_group(const std::string& group) {
+  stream_group_ = group;
+
+  for (auto& tally : collision_mesh_tallies_) tally->set_stream_group(group);
+
+  for (auto& tally : track_length_mesh_tallies_)
+    tally->set_stream_group(group);
+
+  for (auto& tally : source_mesh_tallies_) tally->set_stream_group(group);
+
+  for (auto& tally : noise_source_mesh_tallies_)
+    tally->set_stream_group(group);
+}
+
 void Tallies::score_k_col(double scr) {
 #ifdef ABEILLE_USE_OMP
 #pragma omp atomic
@@ -178,6 +196,20 @@ void Tallies::calc_gen_values() {
   k_trk_vec.push_back(k_trk);
   leak_vec.push_back(leak);
   mig_vec.push_back(mig);
+
+  // Stream the values of this generation to the output file
+  if (settings::stream_generations && mpi::rank == 0) {
+    std::vector<double> vals{k_col, k_abs, k_trk, leak, mig};
+    Output::instance().write_async(
+        [vals, group = stream_group_](H5::File& h5) {
+          append_row(h5, group + "/kcol", {vals[0]});
+          append_row(h5, group + "/kabs", {vals[1]});
+          append_row(h5, group + "/ktrk", {vals[2]});
+          append_row(h5, group + "/leakage", {vals[3]});
+          append_row(h5, group + "/mig-area", {vals[4]});
+        },
+        vals.size() * sizeof(double));
+  }
 }
 
 void Tallies::record_generation(double multiplier) {
@@ -202,13 +234,35 @@ void Tallies::record_generation(double multiplier) {
     tally->record_generation(multiplier);
 }
 
-void Tallies::write_tallies() {
-  if (mpi::rank != 0) return;
+void Tallies::write_tallies(const std::string& group) {
+  // Make sure the scores of all generations are recorded in the mesh tallies,
+  // which requires all nodes.
+  for (auto& tally : collision_mesh_tallies_) tally->finish_batches();
+
+  for (auto& tally : track_length_mesh_tallies_) tally->finish_batches();
+
+  for (auto& tally : source_mesh_tallies_) tally->finish_batches();
+
+  for (auto& tally : noise_source_mesh_tallies_) tally->finish_batches();
+
+  if (mpi::rank != 0) {
+    // Tally servers must send their slices of the mesh tallies to master
+    if (gen > 0 && mpi::is_tally_server()) {
+      for (auto& tally : collision_mesh_tallies_) tally->write_tally(group);
+
+      for (auto& tally : track_length_mesh_tallies_) tally->write_tally(group);
+
+      for (auto& tally : source_mesh_tallies_) tally->write_tally(group);
+
+      for (auto& tally : noise_source_mesh_tallies_) tally->write_tally(group);
+    }
+    return;
+  }
 
   auto& h5 = Output::instance().h5();
 
   // Make results group
-  auto results = h5.createGroup("results");
+  auto results = h5.createGroup(group);
 
   // Record the active number of generations
   results.createAttribute("generations", gen);
@@ -255,16 +309,106 @@ void Tallies::write_tallies() {
 
   // Write all mesh tallies
   if (gen > 0) {
-    for (auto& tally : collision_mesh_tallies_) tally->write_tally();
+    for (auto& tally : collision_mesh_tallies_) tally->write_tally(group);
 
-    for (auto& tally : track_length_mesh_tallies_) tally->write_tally();
+    for (auto& tally : track_length_mesh_tallies_) tally->write_tally(group);
 
-    for (auto& tally : source_mesh_tallies_) tally->write_tally();
+    for (auto& tally : source_mesh_tallies_) tally->write_tally(group);
 
-    for (auto& tally : noise_source_mesh_tallies_) tally->write_tally();
+    for (auto& tally : noise_source_mesh_tallies_) tally->write_tally(group);
   }
 }
 
+void Tallies::gather_mesh_tally_batches() {
+  for (auto& tally : collision_mesh_tallies_) tally->gather_batch();
+
+  for (auto& tally : track_length_mesh_tallies_) tally->gather_batch();
+
+  for (auto& tally : source_mesh_tallies_) tally->gather_batch();
+
+  for (auto& tally : noise_source_mesh_tallies_) tally->gather_batch();
+}
+
+void Tallies::write_checkpoint(H5::Group& grp) const {
+  if (mpi::rank != 0) return;
+
+  grp.createAttribute("generations", gen);
+  grp.createAttribute("keff", keff_);
+  grp.createAttribute("total-weight", total_weight);
+
+  // The current value, average, and variance of each estimator
+  grp.createDataSet("kcol-stats",
+                    std::vector<double>{k_col, k_col_avg, k_col_var});
+  grp.createDataSet("kabs-stats",
+                    std::vector<double>{k_abs, k_abs_avg, k_abs_var});
+  grp.createDataSet("ktrk-stats",
+                    std::vector<double>{k_trk, k_trk_avg, k_trk_var});
+  grp.createDataSet("leakage-stats",
+                    std::vector<double>{leak, leak_avg, leak_var});
+  grp.createDataSet("ktot-stats",
+                    std::vector<double>{k_tot, k_tot_avg, k_tot_var});
+  grp.createDataSet("mig-area-stats",
+                    std::vector<double>{mig, mig_avg, mig_var});
+
+  grp.createDataSet("kcol", k_col_vec);
+  grp.createDataSet("kabs", k_abs_vec);
+  grp.createDataSet("ktrk", k_trk_vec);
+  grp.createDataSet("leakage", leak_vec);
+  grp.createDataSet("mig-area", mig_vec);
+
+  for (const auto& tally : collision_mesh_tallies_)
+    tally->write_checkpoint(grp);
+
+  for (const auto& tally : track_length_mesh_tallies_)
+    tally->write_checkpoint(grp);
+
+  for (const auto& tally : source_mesh_tallies_) tally->write_checkpoint(grp);
+
+  for (const auto& tally : noise_source_mesh_tallies_)
+    tally->write_checkpoint(grp);
+}
+
+// Reads the current value, average, and variance of an estimator
+static void read_statistics(const H5::Group& grp, const std::string& name,
+                            double& x, double& x_avg, double& x_var) {
+  std::vector<double> stats =
+      grp.getDataSet(name).read<std::vector<double>>();
+  if (stats.size() != 3) {
+    fatal_error("Invalid " + name + " dataset in the checkpoint.");
+  }
+
+  x = stats[0];
+  x_avg = stats[1];
+  x_var = stats[2];
+}
+
+void Tallies::read_checkpoint(const H5::Group& grp) {
+  gen = grp.getAttribute("generations").read<int>();
+  keff_ = grp.getAttribute("keff").read<double>();
+  total_weight = grp.getAttribute("total-weight").read<double>();
+
+  read_statistics(grp, "kcol-stats", k_col, k_col_avg, k_col_var);
+  read_statistics(grp, "kabs-stats", k_abs, k_abs_avg, k_abs_var);
+  read_statistics(grp, "ktrk-stats", k_trk, k_trk_avg, k_trk_var);
+  read_statistics(grp, "leakage-stats", leak, leak_avg, leak_var);
+  read_statistics(grp, "ktot-stats", k_tot, k_tot_avg, k_tot_var);
+  read_statistics(grp, "mig-area-stats", mig, mig_avg, mig_var);
+
+  k_col_vec = grp.getDataSet("kcol").read<std::vector<double>>();
+  k_abs_vec = grp.getDataSet("kabs").read<std::vector<double>>();
+  k_trk_vec = grp.getDataSet("ktrk").read<std::vector<double>>();
+  leak_vec = grp.getDataSet("leakage").read<std::vector<double>>();
+  mig_vec = grp.getDataSet("mig-area").read<std::vector<double>>();
+
+  for (auto& tally : collision_mesh_tallies_) tally->read_checkpoint(grp);
+
+  for (auto& tally : track_length_mesh_tallies_) tally->read_checkpoint(grp);
+
+  for (auto& tally : source_mesh_tallies_) tally->read_checkpoint(grp);
+
+  for (auto& tally : noise_source_mesh_tallies_) tally->read_checkpoint(grp);
+}
+
 void Tallies::update_avg_and_var(double x, double& x_avg, double& x_var) {
   double dgen = static_cast<double>(gen);
   double x_avg_old = x_avg;
@@ -156,10 +156,7 @@ void TrackLengthMeshTally::score_flight(const Particle& p, double d,
       uint64_t ui = static_cast<uint64_t>(i);
       uint64_t uj = static_cast<uint64_t>(j);
       uint64_t uk = static_cast<uint64_t>(k);
-#ifdef ABEILLE_USE_OMP
-#pragma omp atomic
-#endif
-      tally_gen(uE, ui, uj, uk) += d_tile * base_score;
+      add_score(uE, ui, uj, uk, d_tile * base_score);
     } else {
       // If we arrive here, it means that we have left the tally region
       // when were we initially inside it. We can return here, as it's
@@ -601,5 +598,6 @@ std::shared_ptr<TrackLengthMeshTally> make_track_length_mesh_tally(
   }
 
   return std::make_shared<TrackLengthMeshTally>(plow, phi, nx, ny, nz, ebounds,
-                                                quantity, fname, mt);
+                                                quantity, fname, mt,
+                                                make_mesh_tally_storage(node));
 }
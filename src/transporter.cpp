@@ -57,13 +57,14 @@ void Transporter::russian_roulette(Particle& p) {
   if (p.wgt() == 0. && p.wgt2() == 0.) p.kill();
 }
 
+template <bool NOISE, bool BRANCHLESS>
 void Transporter::collision(Particle& p, MaterialHelper& mat,
-                            ThreadLocalScores& thread_scores, bool noise,
+                            ThreadLocalScores& thread_scores,
                             const NoiseMaker* noise_maker) {
   // Score flux collision estimator with Sigma_t
   tallies->score_collision(p, mat, settings::converged);
-  if (!noise) {
-    double k_col_scr = p.wgt() * mat.vEf(p.E()) / mat.Et(p.E(), noise);
+  if constexpr (!NOISE) {
+    double k_col_scr = p.wgt() * mat.vEf(p.E()) / mat.Et(p.E(), NOISE);
     double mig_dist = (p.r() - p.r_birth()).norm();
     double mig_area_scr =
         p.wgt() * mat.Ea(p.E()) / mat.Et(p.E()) * mig_dist * mig_dist;
@@ -73,25 +74,29 @@ void Transporter::collision(Particle& p, MaterialHelper& mat,
 
   // Sample noise source from the noise maker.
   if (noise_maker) {
-    noise_maker->sample_noise_source(p, mat, tallies->keff(),
-                                     settings::w_noise);
+    noise_maker->sample_noise_source(p, mat, tallies->keff());
   }
 
-  switch (settings::mode) {
-    case settings::SimulationMode::BRANCHLESS_K_EIGENVALUE: {
-      if (noise) {
-        fatal_error(
-            "Cannot perform noise simulations with branchless collisions.");
-      }
-      branchless_collision(p, mat, thread_scores);
-      break;
-    }
-    default:
-      branching_collision(p, mat, thread_scores, noise);
-      break;
+  // Noise transport with branchless collisions is rejected by
+  // dispatch_transport, so that combination is never instantiated.
+  if constexpr (BRANCHLESS) {
+    branchless_collision(p, mat, thread_scores);
+  } else {
+    branching_collision(p, mat, thread_scores, NOISE);
   }
 }
 
+// The collision routines used by the transport modes of dispatch_transport
+template void Transporter::collision<false, false>(Particle&, MaterialHelper&,
+                                                   ThreadLocalScores&,
+                                                   const NoiseMaker*);
+template void Transporter::collision<false, true>(Particle&, MaterialHelper&,
+                                                  ThreadLocalScores&,
+                                                  const NoiseMaker*);
+template void Transporter::collision<true, false>(Particle&, MaterialHelper&,
+                                                  ThreadLocalScores&,
+                                                  const NoiseMaker*);
+
 void Transporter::branchless_collision(Particle& p, MaterialHelper& mat,
                                        ThreadLocalScores& thread_scores) {
   if (settings::branchless_material) {
@@ -28,6 +28,12 @@
 Universe::Universe(uint32_t i_id, std::string i_name)
     : cell_offset_map{}, id_{i_id}, name_{i_name} {}
 
+UniqueCell Universe::get_neighbor_cell(GeoStack& stack, Position r,
+                                       Direction u, int32_t on_surf,
+                                       uint32_t /*previous*/) const {
+  return this->get_cell(stack, r, u, on_surf);
+}
+
 std::array<int32_t, 3> Universe::get_tile(Position /*r*/,
                                           Direction /*u*/) const {
   return {0, 0, 0};
@@ -39,6 +45,13 @@ double Universe::distance_to_tile_boundary(
   return INF;
 }
 
+double Universe::distance_in_tile(Position /*r_tile*/,
+                                  Direction /*u*/) const {
+  return INF;
+}
+
+double Universe::safety_in_tile(Position /*r_tile*/) const { return 0.; }
+
 uint32_t Universe::id() const { return id_; }
 
 std::string Universe::name() const { return name_; }
@@ -75,6 +75,12 @@ double XCylinder::distance(const Position& r, const Direction& u,
   }
 }
 
+double XCylinder::safety(const Position& r) const {
+  const double y = r.y() - y0;
+  const double z = r.z() - z0;
+  return std::abs(std::sqrt(y * y + z * z) - R);
+}
+
 Direction XCylinder::norm(const Position& r) const {
   return {0., r.y() - y0, r.z() - z0};
 }
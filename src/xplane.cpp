@@ -53,6 +53,8 @@ double XPlane::distance(const Position& r, const Direction& u,
     return diff / u.x();
 }
 
+double XPlane::safety(const Position& r) const { return std::abs(r.x() - x0); }
+
 Direction XPlane::norm(const Position& /*r*/) const { return {1., 0., 0.}; }
 
 //===========================================================================
@@ -75,6 +75,12 @@ double YCylinder::distance(const Position& r, const Direction& u,
   }
 }
 
+double YCylinder::safety(const Position& r) const {
+  const double x = r.x() - x0;
+  const double z = r.z() - z0;
+  return std::abs(std::sqrt(x * x + z * z) - R);
+}
+
 Direction YCylinder::norm(const Position& r) const {
   return {r.x() - x0, 0., r.z() - z0};
 }
@@ -53,6 +53,8 @@ double YPlane::distance(const Position& r, const Direction& u,
     return diff / u.y();
 }
 
+double YPlane::safety(const Position& r) const { return std::abs(r.y() - y0); }
+
 Direction YPlane::norm(const Position& /*r*/) const { return {0., 1., 0.}; }
 
 //===========================================================================
@@ -75,6 +75,12 @@ double ZCylinder::distance(const Position& r, const Direction& u,
   }
 }
 
+double ZCylinder::safety(const Position& r) const {
+  const double x = r.x() - x0;
+  const double y = r.y() - y0;
+  return std::abs(std::sqrt(x * x + y * y) - R);
+}
+
 Direction ZCylinder::norm(const Position& r) const {
   return {r.x() - x0, r.y() - y0, 0.};
 }
@@ -53,6 +53,8 @@ double ZPlane::distance(const Position& r, const Direction& u,
     return diff / u.z();
 }
 
+double ZPlane::safety(const Position& r) const { return std::abs(r.z() - z0); }
+
 Direction ZPlane::norm(const Position& /*r*/) const { return {0., 0., 1.}; }
 
 //===========================================================================